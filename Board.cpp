@@ -0,0 +1,309 @@
+#include "Board.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+using std::endl;
+using std::vector;
+using std::pair;
+
+static int parse_cell(const std::string& token, int line) {
+	if (token == ".") {
+		return -1;
+	}
+	if (token == "#") {
+		return hole;
+	}
+	if (token.size() == 1 && isalpha((unsigned char)token[0])) {
+		return tolower(token[0]) - 'a';
+	}
+	if (!token.empty() && token.size() <= 6 && std::all_of(token.begin(), token.end(), ::isdigit)) {
+		return std::stoi(token);
+	}
+	throw std::runtime_error("Line #" + std::to_string(line) + " contains invalid cell: " + token);
+}
+
+static vector<int> parse_row(const std::string& line, int num_line) {
+	vector<int> row;
+	if (line.find_first_of(" \t") != std::string::npos) {
+		std::istringstream tokens(line);
+		std::string token;
+		while (tokens >> token) {
+			row.push_back(parse_cell(token, num_line));
+		}
+	}
+	else {
+		for (size_t ci = 0; ci < line.size(); ++ci) {
+			row.push_back(parse_cell(std::string(1, line[ci]), num_line));
+		}
+	}
+	return row;
+}
+
+board read_board(std::istream& in) {
+	board hints;
+	return read_board(in, hints);
+}
+
+// Rows may be shorter than the widest one; the missing cells are holes. A
+// row containing whitespace is read as whitespace-separated tokens, which
+// allows numeric colors (0 is the same color as a) for boards with more than
+// 26 colors.
+board read_board(std::istream& in, board& hints) {
+	board parsed;
+	board hint_rows;
+	bool in_hints = false;
+	std::string line;
+	int num_lines = 1;
+	size_t cols = 0;
+	while (std::getline(in, line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.find_first_not_of(" \t") == std::string::npos) {
+			break;
+		}
+		if (line == "+" && !in_hints) {
+			in_hints = true;
+			num_lines++;
+			continue;
+		}
+		vector<int> row = parse_row(line, num_lines);
+		if (in_hints) {
+			if (hint_rows.size() == parsed.size() || row.size() > cols) {
+				throw std::runtime_error("Line #" + std::to_string(num_lines) + " is outside the board");
+			}
+			for (size_t c = 0; c < row.size(); c++) {
+				if (row[c] == hole) {
+					row[c] = -1;
+				}
+			}
+			hint_rows.push_back(row);
+		}
+		else {
+			cols = std::max(cols, row.size());
+			parsed.push_back(row);
+		}
+		num_lines++;
+	}
+	for (auto& row : parsed) {
+		row.resize(cols, hole);
+	}
+	hint_rows.resize(parsed.size());
+	for (auto& row : hint_rows) {
+		row.resize(cols, -1);
+	}
+	hints = hint_rows;
+	return parsed;
+}
+
+// Letters while every color has one, numbers otherwise
+void print_board(const board& b, std::ostream& out) {
+	int max_color = -1;
+	for (auto& row : b) {
+		for (int value : row) {
+			max_color = std::max(max_color, value);
+		}
+	}
+	if (max_color < 26) {
+		print_char_board(board_to_char_board(b), out);
+		return;
+	}
+	int width = std::to_string(max_color).size();
+	for (auto& row : b) {
+		for (int value : row) {
+			std::string token = value == hole ? "#" : value < 0 ? "." : std::to_string(value);
+			out << std::string(width - token.size(), ' ') << token << " ";
+		}
+		out << endl;
+	}
+}
+
+void print_char_board(char_board b, std::ostream& out) {
+	for (int i = 0; i < b.size(); i++) {
+		for (int j = 0; j < b[i].size(); j++) {
+			out << b[i][j] << " ";
+		}
+		out << endl;
+	}
+}
+
+vector<std::string> board_rows(const board& b) {
+	int max_color = -1;
+	for (auto& row : b) {
+		for (int value : row) {
+			max_color = std::max(max_color, value);
+		}
+	}
+	vector<std::string> res;
+	for (auto& row : b) {
+		std::string line;
+		for (int value : row) {
+			if (max_color < 26) {
+				line += value == hole ? '#' : value < 0 ? '.' : (char)('a' + value);
+				continue;
+			}
+			if (!line.empty()) {
+				line += ' ';
+			}
+			line += value == hole ? "#" : value < 0 ? "." : std::to_string(value);
+		}
+		res.push_back(line);
+	}
+	return res;
+}
+
+endpoint_map endpoints_from_board(board b) {
+	endpoint_map res;
+	for (int r = 0; r < b.size(); r++) {
+		for (int c = 0; c < b[0].size(); c++) {
+			if (b[r][c] >= 0) {
+				res[pair<int, int>(r, c)] = b[r][c];
+			}
+		}
+	}
+	return res;
+}
+
+board board_from_endpoints(int rows, int cols, const endpoint_map& endpoints) {
+	board res(rows, vector<int>(cols, -1));
+	for (auto& endpoint : endpoints) {
+		res[endpoint.first.first][endpoint.first.second] = endpoint.second;
+	}
+	return res;
+}
+
+char_board board_to_char_board(board b) {
+	char_board res;
+	for (int r = 0; r < b.size(); r++) {
+		vector<char> row;
+		for (int c = 0; c < b[0].size(); c++) {
+			if (b[r][c] == hole) {
+				row.push_back('#');
+			}
+			else if (b[r][c] == -1) {
+				row.push_back('.');
+			}
+			else {
+				row.push_back('a' + b[r][c]);
+			}
+		}
+		res.push_back(row);
+	}
+	return res;
+}
+
+bool verify_solution(const board& b, const board& solution, std::string* reason) {
+	auto fail = [reason](const std::string& why, int r, int c) {
+		if (reason) {
+			*reason = why;
+			if (r >= 0) {
+				*reason += " at row " + std::to_string(r + 1) + " column " + std::to_string(c + 1);
+			}
+		}
+		return false;
+	};
+	int rows = b.size();
+	int cols = rows ? b[0].size() : 0;
+	if (solution.size() != rows) {
+		return fail("solution has " + std::to_string(solution.size()) + " rows, board " + std::to_string(rows), -1, -1);
+	}
+	// Every row first: counting neighbors reads the next row too
+	for (int r = 0; r < rows; r++) {
+		if (b[r].size() != cols) {
+			return fail("board row has " + std::to_string(b[r].size()) + " cells, first row " + std::to_string(cols), r, 0);
+		}
+		if (solution[r].size() != cols) {
+			return fail("solution row has " + std::to_string(solution[r].size()) + " cells, board " + std::to_string(cols), r, 0);
+		}
+	}
+	const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+	// Same-colored neighbors of every cell, and the endpoints of every color
+	int num_colors = 0;
+	for (auto& row : b) {
+		for (int value : row) {
+			num_colors = std::max(num_colors, value + 1);
+		}
+	}
+	vector<int> degree(rows * cols, 0);
+	vector<vector<int>> ends(num_colors);
+	vector<int> cells(num_colors, 0);
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			int color = solution[r][c];
+			if ((b[r][c] == hole) != (color == hole)) {
+				return fail(b[r][c] == hole ? "cell outside the board is colored" : "hole in the solution", r, c);
+			}
+			if (color == hole) {
+				continue;
+			}
+			if (color < 0) {
+				return fail("empty cell", r, c);
+			}
+			if (color >= num_colors) {
+				return fail("color " + std::to_string(color) + " is not on the board", r, c);
+			}
+			if (b[r][c] >= 0 && b[r][c] != color) {
+				return fail("endpoint changed color", r, c);
+			}
+			cells[color]++;
+			if (b[r][c] >= 0) {
+				ends[color].push_back(r * cols + c);
+			}
+			for (auto& dir : dirs) {
+				int nr = r + dir[0];
+				int nc = c + dir[1];
+				degree[r * cols + c] += nr >= 0 && nc >= 0 && nr < rows && nc < cols && solution[nr][nc] == color;
+			}
+			int expected = b[r][c] >= 0 ? 1 : 2;
+			if (degree[r * cols + c] != expected) {
+				return fail(std::string(expected == 1 ? "endpoint" : "path cell") + " has " + std::to_string(degree[r * cols + c]) + " neighbors of its color", r, c);
+			}
+		}
+	}
+
+	// With those degrees a color is a path between its endpoints plus maybe
+	// loops; walking the path from one end must reach every cell of the color
+	vector<bool> on_path(rows * cols, false);
+	for (int color = 0; color < cells.size(); color++) {
+		if (cells[color] == 0) {
+			continue;
+		}
+		if (ends[color].size() != 2) {
+			int v = 0;
+			while (solution[v / cols][v % cols] != color) {
+				v++;
+			}
+			return fail("color " + std::to_string(color) + " has " + std::to_string(ends[color].size()) + " endpoints", v / cols, v % cols);
+		}
+		int prev = -1;
+		int cur = ends[color][0];
+		int length = 1;
+		on_path[cur] = true;
+		while (cur != ends[color][1]) {
+			int next = -1;
+			for (auto& dir : dirs) {
+				int nr = cur / cols + dir[0];
+				int nc = cur % cols + dir[1];
+				if (nr >= 0 && nc >= 0 && nr < rows && nc < cols && nr * cols + nc != prev && solution[nr][nc] == color) {
+					next = nr * cols + nc;
+				}
+			}
+			prev = cur;
+			cur = next;
+			on_path[cur] = true;
+			length++;
+		}
+		cells[color] -= length;
+	}
+	for (int v = 0; v < rows * cols; v++) {
+		int color = solution[v / cols][v % cols];
+		if (color >= 0 && cells[color] > 0 && !on_path[v]) {
+			return fail("loop of color " + std::to_string(color) + " apart from its path", v / cols, v % cols);
+		}
+	}
+	return true;
+}
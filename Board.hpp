@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+// Hash for (row, col) pairs
+struct cell_hash {
+	std::size_t operator()(const std::pair<int, int>& p) const {
+		return std::hash<long long>()(((long long)p.first << 32) ^ (unsigned)p.second);
+	}
+};
+
+using board = std::vector<std::vector<int>>;
+using char_board = std::vector<std::vector<char>>;
+using endpoint_map = std::unordered_map<std::pair<int, int>, int, cell_hash>;
+
+// Colors are 0.., empty cells -1. Cells that are not part of the board, the
+// holes of an irregular board, are marked with hole.
+const int hole = -2;
+
+board read_board(std::istream& in);
+// Also reads the hints that may follow the board after a line holding just
+// "+": rows in the board format where a color marks a cell known to be on
+// that color's path, and '.' or '#' a cell without a hint. hints has the
+// size of the board, with -1 where there is no hint.
+board read_board(std::istream& in, board& hints);
+void print_board(const board& b, std::ostream& out = std::cout);
+void print_char_board(char_board b, std::ostream& out = std::cout);
+// The rows of b as read_board() reads them: a character per cell, or
+// space-separated numbers if some color has no letter
+std::vector<std::string> board_rows(const board& b);
+char_board board_to_char_board(board b);
+endpoint_map endpoints_from_board(board b);
+board board_from_endpoints(int rows, int cols, const endpoint_map& endpoints);
+// Checks that solution solves b without a solver, in time linear in the
+// number of cells: same shape and holes, every cell colored, the endpoints
+// kept, and each color a single path between its two endpoints, without
+// branches or loops. If not, reason (when given) says where it fails.
+bool verify_solution(const board& b, const board& solution, std::string* reason = nullptr);
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "BoardPack.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::vector;
+
+namespace {
+
+const char magic[8] = { 'F', 'F', 'P', 'A', 'C', 'K', '0', '1' };
+
+struct Header {
+	char magic[8];
+	uint64_t count;
+	uint32_t cell_bytes;
+	uint32_t reserved;
+	uint64_t index_offset;
+};
+
+const uint64_t record_header_size = 8;
+
+uint32_t read32(const uint8_t* p) {
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+void write32(vector<uint8_t>& out, uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		out.push_back((value >> (8 * i)) & 0xff);
+	}
+}
+
+}
+
+int PackedBoard::at(int r, int c) const {
+	const uint8_t* p = cells + ((size_t)r * cols + c) * cell_bytes;
+	switch (cell_bytes) {
+	case 1:
+		return (int)p[0] - 2;
+	case 2:
+		return (int)(p[0] | p[1] << 8) - 2;
+	default:
+		return (int)read32(p) - 2;
+	}
+}
+
+board PackedBoard::to_board() const {
+	board res(rows, vector<int>(cols));
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			res[r][c] = at(r, c);
+		}
+	}
+	return res;
+}
+
+BoardPack::BoardPack(const std::string& path) {
+#ifdef _WIN32
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("Error: could not open board pack " + path);
+	}
+	contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	memory = contents.data();
+	size = contents.size();
+#else
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("Error: could not open board pack " + path);
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw std::runtime_error("Error: could not read board pack " + path);
+	}
+	size = st.st_size;
+	if (size > 0) {
+		memory = (uint8_t*)mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (memory == MAP_FAILED) {
+			close(fd);
+			throw std::runtime_error("Error: could not map board pack " + path);
+		}
+	}
+#endif
+	Header h;
+	bool valid = size >= sizeof(Header);
+	if (valid) {
+		memcpy(&h, memory, sizeof(h));
+		valid = memcmp(h.magic, magic, sizeof(magic)) == 0 && (h.cell_bytes == 1 || h.cell_bytes == 2 || h.cell_bytes == 4)
+			&& h.index_offset >= sizeof(Header) && h.index_offset <= size && h.index_offset % 8 == 0
+			&& h.count < (size - h.index_offset) / 8;
+	}
+	if (!valid) {
+#ifndef _WIN32
+		if (memory) {
+			munmap(memory, size);
+		}
+		close(fd);
+#endif
+		throw std::runtime_error("Error: " + path + " is not a board pack");
+	}
+	num_boards = h.count;
+	cell_bytes = h.cell_bytes;
+	index = (const uint64_t*)(memory + h.index_offset);
+}
+
+BoardPack::~BoardPack() {
+#ifndef _WIN32
+	if (memory) {
+		munmap(memory, size);
+	}
+	close(fd);
+#endif
+}
+
+uint64_t BoardPack::count() const {
+	return num_boards;
+}
+
+PackedBoard BoardPack::view(uint64_t i) const {
+	if (i >= num_boards) {
+		throw std::runtime_error("Error: board " + std::to_string(i) + " is not in the pack");
+	}
+	uint64_t begin = index[i];
+	uint64_t end = index[i + 1];
+	if (begin > end || end > size || end - begin < record_header_size) {
+		throw std::runtime_error("Error: board " + std::to_string(i) + " of the pack is corrupt");
+	}
+	PackedBoard res;
+	res.rows = read32(memory + begin);
+	res.cols = read32(memory + begin + 4);
+	res.cell_bytes = cell_bytes;
+	res.cells = memory + begin + record_header_size;
+	if ((uint64_t)res.rows * res.cols * cell_bytes != end - begin - record_header_size) {
+		throw std::runtime_error("Error: board " + std::to_string(i) + " of the pack is corrupt");
+	}
+	return res;
+}
+
+board BoardPack::get(uint64_t i) const {
+	return view(i).to_board();
+}
+
+PackWriter::PackWriter(const std::string& path, int cell_bytes) : out(path, std::ios::binary | std::ios::trunc), path(path), cell_bytes(cell_bytes) {
+	if (cell_bytes != 1 && cell_bytes != 2 && cell_bytes != 4) {
+		throw std::runtime_error("Error: invalid cell width " + std::to_string(cell_bytes));
+	}
+	if (!out) {
+		throw std::runtime_error("Error: could not create board pack " + path);
+	}
+	// Filled in by finish()
+	Header h = Header();
+	out.write((const char*)&h, sizeof(h));
+	offsets.push_back(sizeof(h));
+}
+
+void PackWriter::add(const board& b) {
+	uint32_t rows = b.size();
+	uint32_t cols = b.empty() ? 0 : b[0].size();
+	uint64_t limit = cell_bytes == 4 ? 0xffffffffull : (1ull << (8 * cell_bytes)) - 1;
+	buffer.clear();
+	write32(buffer, rows);
+	write32(buffer, cols);
+	for (auto& row : b) {
+		for (int value : row) {
+			uint64_t stored = (uint64_t)(value + 2);
+			if (value < hole || stored > limit) {
+				throw std::runtime_error("Error: cell value " + std::to_string(value) + " does not fit the pack");
+			}
+			for (int i = 0; i < cell_bytes; i++) {
+				buffer.push_back((stored >> (8 * i)) & 0xff);
+			}
+		}
+	}
+	out.write((const char*)buffer.data(), buffer.size());
+	offsets.push_back(offsets.back() + buffer.size());
+}
+
+// The index goes after the last board, aligned to 8 bytes so that it can be
+// read in place
+void PackWriter::finish() {
+	uint64_t end = offsets.back();
+	uint64_t index_offset = (end + 7) / 8 * 8;
+	out.write("\0\0\0\0\0\0\0", index_offset - end);
+	out.write((const char*)offsets.data(), offsets.size() * sizeof(uint64_t));
+	Header h = Header();
+	memcpy(h.magic, magic, sizeof(magic));
+	h.count = offsets.size() - 1;
+	h.cell_bytes = cell_bytes;
+	h.index_offset = index_offset;
+	out.seekp(0);
+	out.write((const char*)&h, sizeof(h));
+	out.close();
+	if (!out) {
+		throw std::runtime_error("Error: could not write board pack " + path);
+	}
+}
+
+int pack_cell_bytes(int max_color) {
+	if (max_color + 2 <= 0xff) {
+		return 1;
+	}
+	return max_color + 2 <= 0xffff ? 2 : 4;
+}
+
+bool is_board_pack(const std::string& path) {
+	std::ifstream in(path, std::ios::binary);
+	char start[sizeof(magic)];
+	return in.read(start, sizeof(start)) && memcmp(start, magic, sizeof(magic)) == 0;
+}
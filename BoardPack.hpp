@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Board.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// A board stored in a BoardPack, read in place. Cells are cell_bytes wide,
+// little-endian, row by row, each holding value + 2 (holes are 0, empty
+// cells 1).
+struct PackedBoard {
+	int rows;
+	int cols;
+	int cell_bytes;
+	const uint8_t* cells;
+
+	int at(int r, int c) const;
+	board to_board() const;
+};
+
+// A read-only archive of boards, memory-mapped so that boards are read
+// straight from the file without parsing or copying. The file starts with a
+// fixed-size header (magic, board count, cell width, index offset); each
+// board follows as rows and cols (32 bits each) and its cells, all of the
+// same width; an index of count + 1 offsets, one per board plus the end of
+// the last, closes the file. The header and index are read in place, in the
+// byte order of the machine (the format is little-endian). Throws on I/O
+// errors and on files that are not packs or whose index points outside the
+// file. On Windows the file is read into memory instead.
+class BoardPack {
+private:
+	uint8_t* memory = nullptr;
+	uint64_t size = 0;
+	uint64_t num_boards = 0;
+	int cell_bytes = 1;
+	const uint64_t* index = nullptr;
+	std::vector<uint8_t> contents;  // Without mmap
+#ifndef _WIN32
+	int fd = -1;
+#endif
+
+public:
+	BoardPack(const std::string& path);
+	~BoardPack();
+	BoardPack(const BoardPack&) = delete;
+	BoardPack& operator=(const BoardPack&) = delete;
+
+	uint64_t count() const;
+	// Throws if i is out of range or the record does not fit its index entry
+	PackedBoard view(uint64_t i) const;
+	board get(uint64_t i) const;
+};
+
+// Writes a BoardPack one board at a time. cell_bytes (1, 2 or 4) must hold
+// value + 2 for every cell added; see pack_cell_bytes(). The pack is only
+// complete after finish().
+class PackWriter {
+private:
+	std::ofstream out;
+	std::string path;
+	int cell_bytes;
+	std::vector<uint64_t> offsets;
+	std::vector<uint8_t> buffer;
+
+public:
+	PackWriter(const std::string& path, int cell_bytes);
+	void add(const board& b);
+	void finish();
+};
+
+// The narrowest cell width that holds the largest color (see PackWriter)
+int pack_cell_bytes(int max_color);
+
+// True if the file at path starts like a BoardPack
+bool is_board_pack(const std::string& path);
@@ -2,6 +2,10 @@
 #include <memory>
 
 using std::make_shared;
+using std::string;
+using std::ostream;
+using std::shared_ptr;
+using std::queue;
 
 ostream& operator<<(ostream& os, const BoolExpr& b) {
 	if (b.l && b.r) {
@@ -8,18 +8,12 @@
 #include <memory>
 #include <queue>
 
-using std::map;
-using std::string;
-using std::ostream;
-using std::shared_ptr;
-using std::queue;
-
 struct BoolExpr {
 public:
 	Minisat::Lit val;
-	shared_ptr<BoolExpr> l = nullptr;
-	shared_ptr<BoolExpr> r = nullptr;
-	string op;
+	std::shared_ptr<BoolExpr> l = nullptr;
+	std::shared_ptr<BoolExpr> r = nullptr;
+	std::string op;
 	bool parens = false;
 
 	BoolExpr(Minisat::Lit val) {
@@ -30,19 +24,19 @@ public:
 		this->val = Minisat::mkLit(val);
 	}
 
-	BoolExpr(shared_ptr<BoolExpr> l, shared_ptr<BoolExpr> r, string op) {
+	BoolExpr(std::shared_ptr<BoolExpr> l, std::shared_ptr<BoolExpr> r, std::string op) {
 		this->l = l;
 		this->r = r;
 		this->op = op;
 	}
 };
 
-ostream& operator<<(ostream& os, const BoolExpr& b);
-shared_ptr<BoolExpr> combine(queue<shared_ptr<BoolExpr>> q, string op);
-shared_ptr<BoolExpr> combine(shared_ptr<BoolExpr> l, shared_ptr<BoolExpr> r, string op);
-shared_ptr<BoolExpr> lit(Minisat::Lit val);
-shared_ptr<BoolExpr> lit(int val);
-const shared_ptr<BoolExpr>& parens(const shared_ptr<BoolExpr>& b);
+std::ostream& operator<<(std::ostream& os, const BoolExpr& b);
+std::shared_ptr<BoolExpr> combine(std::queue<std::shared_ptr<BoolExpr>> q, std::string op);
+std::shared_ptr<BoolExpr> combine(std::shared_ptr<BoolExpr> l, std::shared_ptr<BoolExpr> r, std::string op);
+std::shared_ptr<BoolExpr> lit(Minisat::Lit val);
+std::shared_ptr<BoolExpr> lit(int val);
+const std::shared_ptr<BoolExpr>& parens(const std::shared_ptr<BoolExpr>& b);
 
 // Only use on literal
-shared_ptr<BoolExpr> neg(const shared_ptr<BoolExpr>& b);
\ No newline at end of file
+std::shared_ptr<BoolExpr> neg(const std::shared_ptr<BoolExpr>& b);
\ No newline at end of file
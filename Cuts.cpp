@@ -0,0 +1,160 @@
+#include "Cuts.hpp"
+
+#include <algorithm>
+#include <set>
+
+using std::set;
+using std::vector;
+using std::pair;
+
+using cell = std::pair<int, int>;
+
+namespace {
+
+const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+class ColorGraph {
+private:
+	const board& known;
+	int color;
+	int h;
+	int w;
+	vector<int> disc;
+	vector<int> low;
+	vector<int> parent;
+
+public:
+	ColorGraph(const board& known, int color) : known(known), color(color), h(known.size()), w(known[0].size()) {
+	}
+
+	// Depth-first search from a that skips removed. Returns false if b cannot
+	// be reached, otherwise fills in the cells that separate a from b, in
+	// order from b back to a.
+	bool separators(int a, int b, int removed, vector<int>& res) {
+		disc.assign(h * w, -1);
+		low.assign(h * w, 0);
+		parent.assign(h * w, -1);
+		vector<int> next_dir(h * w, 0);
+		vector<int> stack;
+		int time = 0;
+		disc[a] = low[a] = time++;
+		stack.push_back(a);
+		while (!stack.empty()) {
+			int v = stack.back();
+			if (next_dir[v] < 4) {
+				int u = neighbor(v, next_dir[v]++);
+				if (u < 0 || u == removed || !passable(u)) {
+					continue;
+				}
+				if (disc[u] < 0) {
+					parent[u] = v;
+					disc[u] = low[u] = time++;
+					stack.push_back(u);
+				}
+				else if (u != parent[v]) {
+					low[v] = std::min(low[v], disc[u]);
+				}
+			}
+			else {
+				stack.pop_back();
+				if (parent[v] >= 0) {
+					low[parent[v]] = std::min(low[parent[v]], low[v]);
+				}
+			}
+		}
+		if (disc[b] < 0) {
+			return false;
+		}
+		for (int c = b, v = parent[b]; v != a; c = v, v = parent[v]) {
+			if (low[c] >= disc[v]) {
+				res.push_back(v);
+			}
+		}
+		return true;
+	}
+
+	// The a-b path in the tree of the last search, without a and b
+	vector<int> tree_path(int a, int b) {
+		vector<int> res;
+		for (int v = parent[b]; v != a; v = parent[v]) {
+			res.push_back(v);
+		}
+		return res;
+	}
+
+private:
+	bool passable(int v) {
+		int c = known[v / w][v % w];
+		return c == -1 || c == color;
+	}
+
+	int neighbor(int v, int d) {
+		int r = v / w + dirs[d][0];
+		int c = v % w + dirs[d][1];
+		if (r < 0 || c < 0 || r >= h || c >= w) {
+			return -1;
+		}
+		return r * w + c;
+	}
+};
+
+}
+
+CutConstraints find_cut_constraints(const board& known, const endpoint_map& endpoints, bool pairs) {
+	CutConstraints res;
+	if (known.empty()) {
+		return res;
+	}
+	int w = known[0].size();
+	auto to_cell = [w](int v) { return cell(v / w, v % w); };
+
+	vector<vector<int>> color_endpoints;
+	for (auto& endpoint : endpoints) {
+		if (endpoint.second >= color_endpoints.size()) {
+			color_endpoints.resize(endpoint.second + 1);
+		}
+		color_endpoints[endpoint.second].push_back(endpoint.first.first * w + endpoint.first.second);
+	}
+
+	for (int color = 0; color < color_endpoints.size(); color++) {
+		if (color_endpoints[color].size() != 2) {
+			continue;
+		}
+		int a = color_endpoints[color][0];
+		int b = color_endpoints[color][1];
+		ColorGraph g(known, color);
+		vector<int> cuts;
+		if (!g.separators(a, b, -1, cuts)) {
+			res.contradiction = true;
+			return res;
+		}
+		set<int> is_cut(cuts.begin(), cuts.end());
+		for (int v : cuts) {
+			if (known[v / w][v % w] != color) {
+				res.units.push_back(pair<cell, int>(to_cell(v), color));
+			}
+		}
+		if (!pairs) {
+			continue;
+		}
+
+		// Every separating pair has a cell on any a-b path
+		set<pair<int, int>> seen;
+		for (int u : g.tree_path(a, b)) {
+			if (is_cut.count(u) || known[u / w][u % w] == color) {
+				continue;
+			}
+			vector<int> pair_cuts;
+			if (!g.separators(a, b, u, pair_cuts)) {
+				continue;
+			}
+			for (int v : pair_cuts) {
+				if (is_cut.count(v) || known[v / w][v % w] == color || !seen.insert(pair<int, int>(std::min(u, v), std::max(u, v))).second) {
+					continue;
+				}
+				res.binaries.push_back(pair<pair<cell, cell>, int>(pair<cell, cell>(to_cell(u), to_cell(v)), color));
+			}
+		}
+	}
+	return res;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Preprocess.hpp"
+
+#include <vector>
+#include <utility>
+
+// Redundant constraints from the grid graph of each color: its two endpoints
+// plus every cell not fixed to another color. A cell that separates the two
+// endpoints (an articulation point between them) must take the color, and if
+// removing one cell of a color's path makes another cell separating, at least
+// one of the two takes the color.
+struct CutConstraints {
+	std::vector<std::pair<std::pair<int, int>, int>> units;
+	std::vector<std::pair<std::pair<std::pair<int, int>, std::pair<int, int>>, int>> binaries;
+	bool contradiction = false;  // Some color's endpoints are already disconnected
+};
+
+// known is the board with every resolved cell filled in (see preprocess()).
+// Holes are never passable.
+// Binary constraints are only searched for when pairs is set.
+CutConstraints find_cut_constraints(const board& known, const endpoint_map& endpoints, bool pairs);
\ No newline at end of file
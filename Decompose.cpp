@@ -0,0 +1,357 @@
+#include "Decompose.hpp"
+#include "NativeSolver.hpp"
+#include "Validate.hpp"
+#include "Watchdog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <queue>
+#include <thread>
+
+using std::map;
+using std::pair;
+using std::queue;
+using std::vector;
+
+using cell = std::pair<int, int>;
+
+namespace {
+
+const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+struct SubSolution {
+	SolveResult result;
+	board solution;
+	SolverStats stats;
+};
+
+int find(vector<int>& parent, int v) {
+	while (parent[v] != v) {
+		parent[v] = parent[parent[v]];
+		v = parent[v];
+	}
+	return v;
+}
+
+void add_stats(SolverStats& total, const SolverStats& s) {
+	total.vars += s.vars;
+	total.decision_vars += s.decision_vars;
+	total.clauses += s.clauses;
+	total.literals += s.literals;
+	total.decisions += s.decisions;
+	total.conflicts += s.conflicts;
+	total.propagations += s.propagations;
+}
+
+// Sizes as encoded, before the SAT solver simplifies and learns; search
+// counters after the solve
+void take_search_stats(SolverStats& encoded, const SolverStats& searched) {
+	encoded.decisions = searched.decisions;
+	encoded.conflicts = searched.conflicts;
+	encoded.propagations = searched.propagations;
+}
+
+template <class S, class... Hints>
+SolveResult solve_watched(S& s, Watchdog* watchdog, const Hints&... hints) {
+	if (!watchdog) {
+		return s.solve(hints...);
+	}
+	watchdog->watch(s);
+	SolveResult res = s.solve(hints...);
+	watchdog->unwatch(s);
+	return res;
+}
+
+template <class S, class... Args>
+SubSolution solve_with(Watchdog* watchdog, const Args&... args) {
+	S s(args...);
+	SubSolution res;
+	res.stats = s.stats();
+	res.result = solve_watched(s, watchdog);
+	if (res.result == SolveResult::solved) {
+		res.solution = s.get_solution();
+	}
+	take_search_stats(res.stats, s.stats());
+	return res;
+}
+
+// A Solver, or a NativeSolver for the native backend, built from args
+template <class... Args>
+SubSolution solve_with_backend(const SolverOptions& options, Watchdog* watchdog, const Args&... args) {
+	if (options.backend == Backend::native) {
+		return solve_with<NativeSolver>(watchdog, args...);
+	}
+	return solve_with<Solver>(watchdog, args...);
+}
+
+template <class S>
+SubSolution solve_hinted(const board& b, const board& hints, const SolverOptions& options, Watchdog* watchdog, vector<pair<int, int>>& conflicts) {
+	S s(b, options);
+	SubSolution res;
+	res.stats = s.stats();
+	res.result = solve_watched(s, watchdog, hints);
+	if (res.result == SolveResult::solved) {
+		res.solution = s.get_solution();
+	}
+	conflicts = s.conflicting_hints();
+	take_search_stats(res.stats, s.stats());
+	return res;
+}
+
+}
+
+bool decompose(const board& b, const PreprocessResult& pre, vector<Subproblem>& res) {
+	int h = b.size();
+	int w = h ? b[0].size() : 0;
+	auto valid = [&](int r, int c) { return r >= 0 && c >= 0 && r < h && c < w; };
+
+	// Connected components of unresolved cells
+	vector<vector<int>> comp(h, vector<int>(w, -1));
+	int num_comps = 0;
+	for (int r = 0; r < h; r++) {
+		for (int c = 0; c < w; c++) {
+			if (pre.colors[r][c] != -1 || comp[r][c] >= 0) {
+				continue;
+			}
+			queue<cell> q;
+			q.push(cell(r, c));
+			comp[r][c] = num_comps;
+			while (!q.empty()) {
+				cell cur = q.front();
+				q.pop();
+				for (auto& dir : dirs) {
+					int nr = cur.first + dir[0];
+					int nc = cur.second + dir[1];
+					if (valid(nr, nc) && pre.colors[nr][nc] == -1 && comp[nr][nc] < 0) {
+						comp[nr][nc] = num_comps;
+						q.push(cell(nr, nc));
+					}
+				}
+			}
+			num_comps++;
+		}
+	}
+
+	// Loose ends of the colors that are not connected yet. Components that
+	// touch the ends of one color have to be solved together.
+	vector<int> parent(num_comps);
+	for (int i = 0; i < num_comps; i++) {
+		parent[i] = i;
+	}
+	map<int, vector<cell>> ends;
+	map<int, int> end_comp;
+	for (int r = 0; r < h; r++) {
+		for (int c = 0; c < w; c++) {
+			int color = pre.colors[r][c];
+			if (color < 0) {
+				continue;
+			}
+			int same = 0;
+			vector<int> touching;
+			for (auto& dir : dirs) {
+				int nr = r + dir[0];
+				int nc = c + dir[1];
+				if (!valid(nr, nc)) {
+					continue;
+				}
+				if (pre.colors[nr][nc] == color) {
+					same++;
+				}
+				else if (pre.colors[nr][nc] == -1) {
+					touching.push_back(comp[nr][nc]);
+				}
+			}
+			if (same == (b[r][c] >= 0 ? 1 : 2)) {
+				continue;
+			}
+			if (touching.empty()) {
+				return false;
+			}
+			ends[color].push_back(cell(r, c));
+			for (int other : touching) {
+				parent[find(parent, other)] = find(parent, touching[0]);
+			}
+			if (end_comp.count(color)) {
+				parent[find(parent, touching[0])] = find(parent, end_comp[color]);
+			}
+			end_comp[color] = touching[0];
+		}
+	}
+
+	map<int, vector<cell>> group_cells;
+	for (int r = 0; r < h; r++) {
+		for (int c = 0; c < w; c++) {
+			if (comp[r][c] >= 0) {
+				group_cells[find(parent, comp[r][c])].push_back(cell(r, c));
+			}
+		}
+	}
+	map<int, vector<int>> group_colors;
+	for (auto& color : end_comp) {
+		group_colors[find(parent, color.second)].push_back(color.first);
+	}
+
+	for (auto& group : group_cells) {
+		vector<int>& colors = group_colors[group.first];
+		if (colors.empty()) {
+			return false;
+		}
+		vector<cell> cells = group.second;
+		for (int color : colors) {
+			cells.insert(cells.end(), ends[color].begin(), ends[color].end());
+		}
+		Subproblem sub;
+		sub.top = h;
+		sub.left = w;
+		int bottom = 0;
+		int right = 0;
+		for (auto& p : cells) {
+			sub.top = std::min(sub.top, p.first);
+			sub.left = std::min(sub.left, p.second);
+			bottom = std::max(bottom, p.first);
+			right = std::max(right, p.second);
+		}
+		sub.rows = bottom - sub.top + 1;
+		sub.cols = right - sub.left + 1;
+		sub.colors = colors;
+		map<int, int> sub_color;
+		for (int i = 0; i < colors.size(); i++) {
+			sub_color[colors[i]] = i;
+			for (auto& p : ends[colors[i]]) {
+				sub.endpoints[cell(p.first - sub.top, p.second - sub.left)] = i;
+			}
+		}
+		sub.region.live.assign(sub.rows, vector<bool>(sub.cols, false));
+		sub.region.banned.assign(sub.rows, vector<vector<int>>(sub.cols));
+		for (auto& p : cells) {
+			sub.region.live[p.first - sub.top][p.second - sub.left] = true;
+		}
+		// Fixed cells left out of the sub-board still count as neighbors
+		for (auto& p : group.second) {
+			for (auto& dir : dirs) {
+				int nr = p.first + dir[0];
+				int nc = p.second + dir[1];
+				if (!valid(nr, nc) || pre.colors[nr][nc] < 0) {
+					continue;
+				}
+				int lr = nr - sub.top;
+				int lc = nc - sub.left;
+				bool live = lr >= 0 && lc >= 0 && lr < sub.rows && lc < sub.cols && sub.region.live[lr][lc];
+				auto color = sub_color.find(pre.colors[nr][nc]);
+				if (!live && color != sub_color.end()) {
+					sub.region.banned[p.first - sub.top][p.second - sub.left].push_back(color->second);
+				}
+			}
+		}
+		res.push_back(sub);
+	}
+	return true;
+}
+
+SolveResult solve_board(const board& b, SolverOptions options, board& solution, SolverStats& stats) {
+	std::unique_ptr<Watchdog> watchdog;
+	if (options.timeout > 0) {
+		auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeout));
+		watchdog.reset(new Watchdog(std::chrono::steady_clock::now() + limit));
+	}
+	return solve_board(b, options, solution, stats, watchdog.get());
+}
+
+SolveResult solve_board(const board& b, SolverOptions options, board& solution, SolverStats& stats, Watchdog* watchdog) {
+	validate_board(b);
+	if (!unsolvable_reason(b).empty()) {
+		stats = SolverStats();
+		return SolveResult::unsolvable;
+	}
+	if (!options.decompose) {
+		SubSolution res = solve_with_backend(options, watchdog, b, options);
+		if (res.result == SolveResult::solved) {
+			solution = res.solution;
+		}
+		stats = res.stats;
+		return res.result;
+	}
+
+	PreprocessResult pre = preprocess(b);
+	stats = SolverStats();
+	stats.fixed_cells = pre.resolved;
+	stats.free_cells = pre.free_cells;
+	vector<Subproblem> subs;
+	if (pre.contradiction || !decompose(b, pre, subs)) {
+		return SolveResult::unsolvable;
+	}
+
+	// Sub-boards are already preprocessed as part of the whole board
+	SolverOptions sub_options = options;
+	sub_options.preprocess = false;
+	// No more threads than cores, each taking the next region until none is
+	// left; a board may split into hundreds of regions
+	vector<SubSolution> results(subs.size());
+	std::atomic<size_t> next(0);
+	size_t num_threads = std::min<size_t>(subs.size(), std::max(1u, std::thread::hardware_concurrency()));
+	vector<std::future<void>> futures;
+	for (size_t t = 0; t < num_threads; t++) {
+		futures.push_back(std::async(std::launch::async, [&subs, &results, &next, sub_options, watchdog]() {
+			for (size_t i = next++; i < subs.size(); i = next++) {
+				auto& sub = subs[i];
+				results[i] = solve_with_backend(sub_options, watchdog, sub.rows, sub.cols, sub.endpoints, sub_options, sub.region);
+			}
+		}));
+	}
+	for (auto& future : futures) {
+		future.get();
+	}
+
+	// One unsolvable region makes the board unsolvable, whatever the others do.
+	// Otherwise the first region that gave up says why.
+	board stitched = pre.colors;
+	SolveResult result = SolveResult::solved;
+	for (int i = 0; i < subs.size(); i++) {
+		SubSolution& res = results[i];
+		add_stats(stats, res.stats);
+		if (res.result != SolveResult::solved) {
+			if (result == SolveResult::solved || res.result == SolveResult::unsolvable) {
+				result = res.result;
+			}
+			continue;
+		}
+		for (int r = 0; r < subs[i].rows; r++) {
+			for (int c = 0; c < subs[i].cols; c++) {
+				if (subs[i].region.live[r][c]) {
+					stitched[subs[i].top + r][subs[i].left + c] = subs[i].colors[res.solution[r][c]];
+				}
+			}
+		}
+	}
+	if (result == SolveResult::solved) {
+		solution = stitched;
+	}
+	return result;
+}
+
+SolveResult solve_board(const board& b, const board& hints, SolverOptions options, board& solution, SolverStats& stats, vector<pair<int, int>>& conflicts, Watchdog* watchdog) {
+	validate_board(b);
+	if (!unsolvable_reason(b).empty()) {
+		stats = SolverStats();
+		conflicts.clear();
+		return SolveResult::unsolvable;
+	}
+	std::unique_ptr<Watchdog> own;
+	if (!watchdog && options.timeout > 0) {
+		auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeout));
+		own.reset(new Watchdog(std::chrono::steady_clock::now() + limit));
+		watchdog = own.get();
+	}
+	SubSolution res = options.backend == Backend::native
+		? solve_hinted<NativeSolver>(b, hints, options, watchdog, conflicts)
+		: solve_hinted<Solver>(b, hints, options, watchdog, conflicts);
+	if (res.result == SolveResult::solved) {
+		solution = res.solution;
+	}
+	stats = res.stats;
+	return res.result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Preprocess.hpp"
+#include "Solver.hpp"
+
+#include <vector>
+
+// A set of unresolved cells that no other set interacts with, cut out of the
+// board as its own sub-board (its bounding box). The loose ends of the colors
+// routed through it become the sub-board's endpoints.
+struct Subproblem {
+	int top;
+	int left;
+	int rows;
+	int cols;
+	endpoint_map endpoints;
+	std::vector<int> colors;  // Sub-board color -> board color
+	Region region;
+};
+
+// Splits the cells preprocessing left unresolved into connected components
+// and merges components that share a color. Returns false if some component
+// cannot be reached by any color.
+bool decompose(const board& b, const PreprocessResult& pre, std::vector<Subproblem>& res);
+
+class Watchdog;
+
+// Solves b, region by region on separate threads when options.decompose is
+// set, within options.timeout. solution is only filled in if the board is
+// solved. Throws for boards validate_board() rejects, and returns unsolvable
+// at once for those unsolvable_reason() proves unsolvable.
+SolveResult solve_board(const board& b, SolverOptions options, board& solution, SolverStats& stats);
+// The same, with every solver watched by watchdog instead of a watchdog for
+// options.timeout.
+SolveResult solve_board(const board& b, SolverOptions options, board& solution, SolverStats& stats, Watchdog* watchdog);
+// Solves b with the colored cells of hints (see read_board) as assumptions,
+// the whole board at once whatever options.decompose says. If the board is
+// unsolvable, conflicts receives the hinted cells that cannot all be right
+// (see Solver::conflicting_hints). Without a watchdog, one is made for
+// options.timeout.
+SolveResult solve_board(const board& b, const board& hints, SolverOptions options, board& solution, SolverStats& stats, std::vector<std::pair<int, int>>& conflicts, Watchdog* watchdog = nullptr);
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "HintService.hpp"
+
+using std::vector;
+
+namespace {
+
+const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+}
+
+HintService::HintService(const board& b, SolverOptions options, int64_t probe_conflicts) : b(b), options(options), probe_conflicts(probe_conflicts), solver(b, options) {
+}
+
+Hint HintService::forced_cells(const board& state) {
+	return probe(state, false);
+}
+
+Hint HintService::next_move(const board& state) {
+	return probe(state, true);
+}
+
+Hint HintService::probe(const board& state, bool first_only) {
+	Hint res;
+	int rows = b.size();
+	int cols = rows ? b[0].size() : 0;
+	res.forced.assign(rows, vector<int>(cols, -1));
+	solver.set_budget(options.conflict_budget, options.propagation_budget);
+	res.result = solver.solve(state);
+	if (res.result == SolveResult::unsolvable) {
+		res.conflicts = solver.conflicting_hints();
+	}
+	if (res.result != SolveResult::solved) {
+		return res;
+	}
+	board model = solver.get_solution();
+
+	// Empty cells, those next to a colored cell of their model color first
+	vector<int> frontier;
+	vector<int> rest;
+	vector<bool> open(rows * cols, false);
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (b[r][c] != -1 || state[r][c] >= 0) {
+				continue;
+			}
+			open[r * cols + c] = true;
+			bool extends = false;
+			for (auto& dir : dirs) {
+				int nr = r + dir[0];
+				int nc = c + dir[1];
+				if (nr >= 0 && nc >= 0 && nr < rows && nc < cols && model[nr][nc] == model[r][c] && (b[nr][nc] >= 0 || state[nr][nc] >= 0)) {
+					extends = true;
+				}
+			}
+			(extends ? frontier : rest).push_back(r * cols + c);
+		}
+	}
+	if (!first_only) {
+		frontier.insert(frontier.end(), rest.begin(), rest.end());
+	}
+	int num_frontier = first_only ? frontier.size() : frontier.size() - rest.size();
+
+	solver.set_budget(probe_conflicts, -1);
+	for (int i = 0; i < frontier.size(); i++) {
+		int v = frontier[i];
+		if (!open[v]) {
+			continue;
+		}
+		open[v] = false;
+		int r = v / cols;
+		int c = v % cols;
+		SolveResult probed = solver.solve_excluding(state, r, c, model[r][c]);
+		if (probed == SolveResult::unsolvable) {
+			res.forced[r][c] = model[r][c];
+			if (res.row < 0 && i < num_frontier) {
+				res.row = r;
+				res.col = c;
+				res.color = model[r][c];
+				if (first_only) {
+					break;
+				}
+			}
+		}
+		else if (probed == SolveResult::solved) {
+			// Cells this completion colors differently are not forced either
+			board other = solver.get_solution();
+			for (int u = 0; u < rows * cols; u++) {
+				if (other[u / cols][u % cols] != model[u / cols][u % cols]) {
+					open[u] = false;
+				}
+			}
+		}
+	}
+	return res;
+}
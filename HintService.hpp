@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Solver.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// What HintService found for a player's partial state
+struct Hint {
+	// solved if the state can still be completed, unsolvable if it cannot,
+	// indeterminate if the search for a completion ran out of budget
+	SolveResult result = SolveResult::indeterminate;
+	// If unsolvable: drawn cells that cannot all be right
+	std::vector<std::pair<int, int>> conflicts;
+	// Color every completion gives to an empty cell, -1 where the probes did
+	// not show one (or were not run)
+	board forced;
+	// A forced cell that extends a path, row -1 if there is none
+	int row = -1;
+	int col = -1;
+	int color = -1;
+};
+
+// Answers hint requests for one board against the player's drawing, which
+// has the board's size and the color of each drawn cell (-1 for none). A
+// single Solver is kept for the board, so each request only adds the drawing
+// as assumptions and reuses what earlier requests learnt.
+//
+// A cell is forced when the solver finds no completion with the cell in
+// another color than in the first completion found. Each such probe is a
+// solve limited to probe_conflicts conflicts; a probe that runs out proves
+// nothing. Every completion a probe finds also clears the cells it colors
+// differently, which no longer need probing. Cells next to a drawn cell or
+// endpoint of their color are probed first, so next_move() usually stops
+// after a handful of probes.
+//
+// Not safe to use from several threads at once.
+class HintService {
+private:
+	board b;
+	SolverOptions options;
+	int64_t probe_conflicts;
+	Solver solver;
+
+public:
+	// options.backend must not be native; its budgets limit the search for
+	// the first completion of each request
+	HintService(const board& b, SolverOptions options = SolverOptions(), int64_t probe_conflicts = 1000);
+	HintService(const HintService&) = delete;
+	HintService& operator=(const HintService&) = delete;
+	// Probes every empty cell
+	Hint forced_cells(const board& state);
+	// Probes until it finds a forced cell, preferring cells that extend a path
+	Hint next_move(const board& state);
+
+private:
+	Hint probe(const board& state, bool first_only);
+};
@@ -0,0 +1,324 @@
+#include "NativeSolver.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using std::vector;
+
+namespace {
+
+const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+Region holes_region(const board& b) {
+	Region res;
+	for (auto& row : b) {
+		if (std::find(row.begin(), row.end(), hole) != row.end()) {
+			for (auto& cells : b) {
+				res.live.push_back(vector<bool>());
+				for (int value : cells) {
+					res.live.back().push_back(value != hole);
+				}
+			}
+			break;
+		}
+	}
+	return res;
+}
+
+}
+
+NativeSolver::NativeSolver(const board& b, SolverOptions options) : NativeSolver(b.size(), b.empty() ? 0 : b[0].size(), endpoints_from_board(b), options, holes_region(b)) {
+}
+
+NativeSolver::NativeSolver(int rows, int cols, endpoint_map endpoints, SolverOptions options, Region region) : options(options), rows(rows), cols(cols), interrupted(false) {
+	int n = rows * cols;
+	live.assign(n, true);
+	banned.assign(n, vector<int>());
+	grid.assign(n, -1);
+	hint.assign(n, -1);
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			int v = r * cols + c;
+			if (!region.live.empty() && !region.live[r][c]) {
+				live[v] = false;
+				grid[v] = hole;
+			}
+			else if (!region.banned.empty()) {
+				banned[v] = region.banned[r][c];
+			}
+		}
+	}
+	adj.assign(n, vector<int>());
+	for (int v = 0; v < n; v++) {
+		for (auto& dir : dirs) {
+			int r = v / cols + dir[0];
+			int c = v % cols + dir[1];
+			if (live[v] && r >= 0 && c >= 0 && r < rows && c < cols && live[r * cols + c]) {
+				adj[v].push_back(r * cols + c);
+			}
+		}
+		free_cells += live[v];
+	}
+
+	int num_colors = 0;
+	for (auto& endpoint : endpoints) {
+		num_colors = std::max(num_colors, endpoint.second + 1);
+	}
+	vector<vector<int>> ends(num_colors);
+	for (auto& endpoint : endpoints) {
+		int v = endpoint.first.first * cols + endpoint.first.second;
+		ends[endpoint.second].push_back(v);
+		grid[v] = endpoint.second;
+		free_cells--;
+	}
+	head.assign(num_colors, -1);
+	target.assign(num_colors, -1);
+	done.assign(num_colors, true);
+	auto empty_neighbors = [this](int v) {
+		int res = 0;
+		for (int u : adj[v]) {
+			res += grid[u] == -1;
+		}
+		return res;
+	};
+	for (int color = 0; color < num_colors; color++) {
+		if (ends[color].empty()) {
+			continue;
+		}
+		if (ends[color].size() != 2) {
+			impossible = true;
+			continue;
+		}
+		// Grow from the endpoint with fewer ways out
+		int a = ends[color][0];
+		int b = ends[color][1];
+		if (empty_neighbors(b) < empty_neighbors(a)) {
+			std::swap(a, b);
+		}
+		head[color] = a;
+		target[color] = b;
+		done[color] = std::find(adj[a].begin(), adj[a].end(), b) != adj[a].end();
+	}
+}
+
+SolveResult NativeSolver::solve() {
+	if (impossible) {
+		return SolveResult::unsolvable;
+	}
+	int res = search();
+	if (res > 0) {
+		return SolveResult::solved;
+	}
+	return res == 0 ? SolveResult::unsolvable : SolveResult::indeterminate;
+}
+
+SolveResult NativeSolver::solve(const board& hints) {
+	if (hints.size() != rows || (rows && hints[0].size() != cols)) {
+		throw std::runtime_error("Error: hints do not have the size of the board");
+	}
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			int v = r * cols + c;
+			int color = hints[r][c];
+			if (color < 0) {
+				continue;
+			}
+			if (!live[v] || color >= head.size() || head[color] < 0) {
+				throw std::runtime_error("Error: hint at row " + std::to_string(r + 1) + " column " + std::to_string(c + 1) + " is not a color of the board");
+			}
+			if (grid[v] >= 0 && grid[v] != color) {
+				return SolveResult::unsolvable;
+			}
+			hint[v] = color;
+		}
+	}
+	return solve();
+}
+
+std::vector<std::pair<int, int>> NativeSolver::conflicting_hints() {
+	return std::vector<std::pair<int, int>>();
+}
+
+void NativeSolver::interrupt() {
+	interrupted = true;
+}
+
+void NativeSolver::clear_interrupt() {
+	interrupted = false;
+}
+
+board NativeSolver::get_solution() {
+	board res(rows, vector<int>(cols));
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			res[r][c] = grid[r * cols + c];
+		}
+	}
+	return res;
+}
+
+SolverStats NativeSolver::stats() {
+	SolverStats res = SolverStats();
+	res.decisions = decisions;
+	res.conflicts = conflicts;
+	res.propagations = propagations;
+	res.free_cells = free_cells;
+	return res;
+}
+
+bool NativeSolver::out_of_budget() {
+	return interrupted
+		|| (options.conflict_budget >= 0 && conflicts >= (uint64_t)options.conflict_budget)
+		|| (options.propagation_budget >= 0 && propagations >= (uint64_t)options.propagation_budget);
+}
+
+int NativeSolver::search() {
+	if (out_of_budget()) {
+		return -1;
+	}
+	if (!feasible()) {
+		conflicts++;
+		return 0;
+	}
+
+	int color = -1;
+	vector<int> moves;
+	for (int k = 0; k < head.size() && (color < 0 || !moves.empty()); k++) {
+		if (done[k]) {
+			continue;
+		}
+		vector<int> cur;
+		for (int to : adj[head[k]]) {
+			if (can_move(k, to)) {
+				cur.push_back(to);
+			}
+		}
+		if (color < 0 || cur.size() < moves.size()) {
+			color = k;
+			moves.swap(cur);
+		}
+	}
+	if (color < 0) {
+		// Every path is done, and feasible() saw no empty cell left
+		return 1;
+	}
+	if (moves.empty()) {
+		conflicts++;
+		return 0;
+	}
+	// Cells with fewer ways out first: paths that hug walls and other paths
+	auto ways_out = [this](int v) {
+		int res = 0;
+		for (int u : adj[v]) {
+			res += grid[u] == -1;
+		}
+		return res;
+	};
+	std::stable_sort(moves.begin(), moves.end(), [&](int a, int b) { return ways_out(a) < ways_out(b); });
+
+	int from = head[color];
+	for (int to : moves) {
+		if (moves.size() == 1) {
+			propagations++;
+		}
+		else {
+			decisions++;
+		}
+		grid[to] = color;
+		head[color] = to;
+		done[color] = std::find(adj[to].begin(), adj[to].end(), target[color]) != adj[to].end();
+		int res = search();
+		if (res != 0) {
+			return res;
+		}
+		grid[to] = -1;
+		head[color] = from;
+		done[color] = false;
+	}
+	return 0;
+}
+
+// to is empty, allowed for the color by the region and the hints, and touches no cell of the path but
+// its head (and the endpoint it grows towards, which finishes the path)
+bool NativeSolver::can_move(int color, int to) {
+	if (grid[to] != -1 || (hint[to] >= 0 && hint[to] != color) || std::find(banned[to].begin(), banned[to].end(), color) != banned[to].end()) {
+		return false;
+	}
+	for (int u : adj[to]) {
+		if (grid[u] == color && u != head[color] && u != target[color]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool NativeSolver::feasible() {
+	int n = rows * cols;
+	// Connected areas of empty cells
+	comp.assign(n, -1);
+	int num_comps = 0;
+	vector<int> stack;
+	for (int v = 0; v < n; v++) {
+		if (grid[v] != -1 || comp[v] >= 0) {
+			continue;
+		}
+		comp[v] = num_comps;
+		stack.push_back(v);
+		while (!stack.empty()) {
+			int cur = stack.back();
+			stack.pop_back();
+			for (int u : adj[cur]) {
+				if (grid[u] == -1 && comp[u] < 0) {
+					comp[u] = num_comps;
+					stack.push_back(u);
+				}
+			}
+		}
+		num_comps++;
+	}
+
+	// Every unfinished path needs an area touching both of its ends, and
+	// every area needs a path that can get through it
+	vector<bool> covered(num_comps, false);
+	vector<bool> open_end(n, false);
+	for (int k = 0; k < head.size(); k++) {
+		if (done[k]) {
+			continue;
+		}
+		open_end[head[k]] = open_end[target[k]] = true;
+		bool reachable = false;
+		for (int u : adj[head[k]]) {
+			if (grid[u] != -1) {
+				continue;
+			}
+			for (int w : adj[target[k]]) {
+				if (grid[w] == -1 && comp[w] == comp[u]) {
+					covered[comp[u]] = true;
+					reachable = true;
+				}
+			}
+		}
+		if (!reachable) {
+			return false;
+		}
+	}
+	if (std::find(covered.begin(), covered.end(), false) != covered.end()) {
+		return false;
+	}
+
+	// A path through an empty cell enters and leaves it
+	for (int v = 0; v < n; v++) {
+		if (grid[v] != -1) {
+			continue;
+		}
+		int ways = 0;
+		for (int u : adj[v]) {
+			ways += grid[u] == -1 || open_end[u];
+		}
+		if (ways < 2) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Solver.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Solves a board without SAT (options.backend native): a depth-first search
+// that grows one path at a time from one of its endpoints, always extending
+// the path with the fewest possible moves. A move may not touch the path's
+// own earlier cells, which keeps every cell at two same-colored neighbors.
+// After each move the search backtracks if some path can no longer reach its
+// other endpoint, if some empty area is not reachable by any unfinished path,
+// or if an empty cell has fewer than two neighbors it could connect to.
+//
+// Decisions are moves with more than one choice, propagations forced moves
+// and conflicts backtracks; the conflict and propagation budgets apply to
+// those. The memory limit and progress reports are not supported. Hints
+// keep other colors out of the hinted cells; which hints conflict is not
+// reported.
+class NativeSolver : public Interruptible {
+private:
+	SolverOptions options;
+	int rows;
+	int cols;
+	std::vector<bool> live;
+	std::vector<std::vector<int>> adj;
+	std::vector<std::vector<int>> banned;
+	std::vector<int> grid;    // Color of each cell, -1 if empty, hole outside the region
+	std::vector<int> head;    // Cell each path grows from
+	std::vector<int> target;  // The endpoint it grows towards
+	std::vector<bool> done;
+	std::vector<int> hint;    // Only color allowed in each cell, -1 for any
+	std::vector<int> comp;    // Scratch space for feasible()
+	bool impossible = false;
+	int free_cells = 0;
+	uint64_t decisions = 0;
+	uint64_t propagations = 0;
+	uint64_t conflicts = 0;
+	std::atomic<bool> interrupted;
+
+public:
+	NativeSolver(const board& b, SolverOptions options = SolverOptions());
+	NativeSolver(int rows, int cols, endpoint_map endpoints, SolverOptions options = SolverOptions(), Region region = Region());
+	SolveResult solve();
+	// hints as for Solver::solve(hints); a NativeSolver solves only once
+	SolveResult solve(const board& hints);
+	// Always empty
+	std::vector<std::pair<int, int>> conflicting_hints();
+	void interrupt() override;
+	void clear_interrupt() override;
+	board get_solution();
+	SolverStats stats();
+
+private:
+	// 1 solved, 0 no solution below this point, -1 gave up
+	int search();
+	bool can_move(int color, int to);
+	bool feasible();
+	bool out_of_budget();
+};
@@ -0,0 +1,237 @@
+#include "Options.hpp"
+
+#include <stdexcept>
+
+using std::endl;
+using std::string;
+using std::ostream;
+
+static bool split_flag(const string& arg, string& name, string& value) {
+	if (arg.compare(0, 2, "--") != 0) {
+		return false;
+	}
+	size_t eq = arg.find('=');
+	name = arg.substr(2, eq == string::npos ? string::npos : eq - 2);
+	value = eq == string::npos ? "" : arg.substr(eq + 1);
+	return true;
+}
+
+static DecisionOrder parse_order(const string& value) {
+	if (value == "vsids") {
+		return DecisionOrder::vsids;
+	}
+	if (value == "color-major") {
+		return DecisionOrder::color_major;
+	}
+	if (value == "endpoint-distance") {
+		return DecisionOrder::endpoint_distance;
+	}
+	throw std::runtime_error("Error: unknown decision order: " + value);
+}
+
+static CutLevel parse_cuts(const string& value) {
+	if (value == "none") {
+		return CutLevel::none;
+	}
+	if (value == "units") {
+		return CutLevel::units;
+	}
+	if (value == "pairs") {
+		return CutLevel::pairs;
+	}
+	throw std::runtime_error("Error: unknown cut constraint level: " + value);
+}
+
+static Acyclicity parse_acyclic(const string& value) {
+	if (value == "none") {
+		return Acyclicity::none;
+	}
+	if (value == "unary") {
+		return Acyclicity::unary;
+	}
+	if (value == "binary") {
+		return Acyclicity::binary;
+	}
+	throw std::runtime_error("Error: unknown acyclicity encoding: " + value);
+}
+
+static ColorEncoding parse_encoding(const string& value) {
+	if (value == "one-hot") {
+		return ColorEncoding::one_hot;
+	}
+	if (value == "log") {
+		return ColorEncoding::log;
+	}
+	if (value == "auto") {
+		return ColorEncoding::automatic;
+	}
+	throw std::runtime_error("Error: unknown color encoding: " + value);
+}
+
+static int parse_megabytes(const string& value) {
+	size_t end = 0;
+	int res = 0;
+	try {
+		res = std::stoi(value, &end);
+	}
+	catch (const std::logic_error&) {
+		end = 0;
+	}
+	if (end == 0 || end != value.size() || res <= 0) {
+		throw std::runtime_error("Error: invalid size in megabytes: " + value);
+	}
+	return res;
+}
+
+static int64_t parse_count(const string& value) {
+	size_t end = 0;
+	long long res = 0;
+	try {
+		res = std::stoll(value, &end);
+	}
+	catch (const std::logic_error&) {
+		end = 0;
+	}
+	if (end == 0 || end != value.size() || res < 0) {
+		throw std::runtime_error("Error: invalid count: " + value);
+	}
+	return res;
+}
+
+static double parse_seconds(const string& value) {
+	size_t end = 0;
+	double res = 0;
+	try {
+		res = std::stod(value, &end);
+	}
+	catch (const std::logic_error&) {
+		end = 0;
+	}
+	if (end == 0 || end != value.size() || !(res > 0)) {
+		throw std::runtime_error("Error: invalid number of seconds: " + value);
+	}
+	return res;
+}
+
+static ProgressFormat parse_progress(const string& value) {
+	if (value == "text" || value.empty()) {
+		return ProgressFormat::text;
+	}
+	if (value == "json") {
+		return ProgressFormat::json;
+	}
+	throw std::runtime_error("Error: unknown progress format: " + value);
+}
+
+static Backend parse_backend(const string& value) {
+	if (value == "minisat") {
+		return Backend::minisat;
+	}
+	if (value == "simp") {
+		return Backend::simp;
+	}
+	if (value == "native") {
+		return Backend::native;
+	}
+	throw std::runtime_error("Error: unknown backend: " + value);
+}
+
+static VarLayout parse_layout(const string& value) {
+	if (value == "color-major") {
+		return VarLayout::color_major;
+	}
+	if (value == "cell-major") {
+		return VarLayout::cell_major;
+	}
+	if (value == "morton") {
+		return VarLayout::morton;
+	}
+	throw std::runtime_error("Error: unknown variable layout: " + value);
+}
+
+bool parse_solver_option(const string& arg, SolverOptions& options) {
+	string name, value;
+	if (!split_flag(arg, name, value)) {
+		return false;
+	}
+	if (name == "backend") {
+		options.backend = parse_backend(value);
+	}
+	else if (name == "order") {
+		options.order = parse_order(value);
+	}
+	else if (name == "encoding") {
+		options.encoding = parse_encoding(value);
+	}
+	else if (name == "encoder-budget") {
+		options.encoder_budget_mb = parse_megabytes(value);
+	}
+	else if (name == "layout") {
+		options.layout = parse_layout(value);
+	}
+	else if (name == "decide-aux") {
+		options.decide_aux = true;
+	}
+	else if (name == "no-preprocess") {
+		options.preprocess = false;
+	}
+	else if (name == "cuts") {
+		options.cuts = parse_cuts(value);
+	}
+	else if (name == "block-clauses") {
+		options.block_clauses = true;
+	}
+	else if (name == "shortcut-clauses") {
+		options.shortcut_clauses = true;
+	}
+	else if (name == "acyclic") {
+		options.acyclic = parse_acyclic(value);
+	}
+	else if (name == "decompose") {
+		options.decompose = true;
+	}
+	else if (name == "timeout") {
+		options.timeout = parse_seconds(value);
+	}
+	else if (name == "conflicts") {
+		options.conflict_budget = parse_count(value);
+	}
+	else if (name == "propagations") {
+		options.propagation_budget = parse_count(value);
+	}
+	else if (name == "memory-limit") {
+		options.memory_limit_mb = parse_megabytes(value);
+	}
+	else if (name == "progress") {
+		options.progress = parse_progress(value);
+	}
+	else if (name == "progress-interval") {
+		options.progress_interval = parse_seconds(value);
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+void solver_options_usage(ostream& os) {
+	os << "Solver options:" << endl;
+	os << "  --backend=<minisat|simp|native>                SAT solver, SAT with variable elimination, or path search (default minisat)" << endl;
+	os << "  --order=<vsids|color-major|endpoint-distance>  initial decision order (default vsids)" << endl;
+	os << "  --encoding=<auto|one-hot|log>                  one variable per color, or colors in binary (default auto)" << endl;
+	os << "  --encoder-budget=<MB>                          reject boards estimated to need more memory (default 2048)" << endl;
+	os << "  --layout=<color-major|cell-major|morton>       numbering of the cell variables (default color-major)" << endl;
+	os << "  --decide-aux                                   allow branching on Tseitin auxiliaries" << endl;
+	os << "  --no-preprocess                                skip the forced-move deductions" << endl;
+	os << "  --cuts=<none|units|pairs>                      add articulation point constraints per color (default none)" << endl;
+	os << "  --block-clauses                                forbid 2x2 blocks of one color" << endl;
+	os << "  --shortcut-clauses                             forbid paths around three sides of an empty cell" << endl;
+	os << "  --acyclic=<none|unary|binary>                  rule out detached same-color cycles with ranks (default none)" << endl;
+	os << "  --decompose                                    solve independent regions of the board in parallel" << endl;
+	os << "  --timeout=<seconds>                            give up after this much wall-clock time" << endl;
+	os << "  --conflicts=<n>                                give up after n conflicts (per region with --decompose)" << endl;
+	os << "  --propagations=<n>                             give up after n propagations (per region with --decompose)" << endl;
+	os << "  --memory-limit=<MB>                            give up when the search needs more memory (per region with --decompose)" << endl;
+	os << "  --progress[=<text|json>]                       report search progress on stderr" << endl;
+	os << "  --progress-interval=<seconds>                  time between progress reports (default 1)" << endl;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Solver.hpp"
+
+#include <iostream>
+#include <string>
+
+// Applies a single "--name[=value]" command line flag to options. Returns
+// false if arg is not a solver option, throws on an invalid value.
+bool parse_solver_option(const std::string& arg, SolverOptions& options);
+void solver_options_usage(std::ostream& os);
\ No newline at end of file
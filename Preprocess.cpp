@@ -0,0 +1,185 @@
+#include "Preprocess.hpp"
+
+using std::vector;
+using std::pair;
+
+using cell = std::pair<int, int>;
+
+namespace {
+
+const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+enum class Edge {
+	unknown,
+	different
+};
+
+class Preprocessor {
+private:
+	int h;
+	int w;
+	vector<bool> live;
+	vector<int> need;
+	vector<int> parent;
+	vector<int> group_color;
+	vector<Edge> edges;
+	bool contradiction = false;
+
+public:
+	Preprocessor(const board& b) : h(b.size()), w(b.empty() ? 0 : b[0].size()) {
+		for (int r = 0; r < h; r++) {
+			for (int c = 0; c < w; c++) {
+				live.push_back(b[r][c] != hole);
+				need.push_back(b[r][c] >= 0 ? 1 : 2);
+				parent.push_back(r * w + c);
+				group_color.push_back(b[r][c]);
+			}
+		}
+		edges.assign(h * w * 4, Edge::unknown);
+	}
+
+	PreprocessResult run(const board& b) {
+		while (!contradiction && sweep()) {
+		}
+		PreprocessResult res;
+		res.colors = b;
+		res.contradiction = contradiction;
+		for (int r = 0; r < h; r++) {
+			for (int c = 0; c < w; c++) {
+				int v = r * w + c;
+				if (!live[v]) {
+					continue;
+				}
+				if (b[r][c] < 0) {
+					res.free_cells++;
+					res.colors[r][c] = group_color[find(v)];
+					if (res.colors[r][c] >= 0) {
+						res.resolved++;
+					}
+				}
+				// Each edge once, from its upper/left cell
+				for (int d = 0; d < 4; d += 2) {
+					int u = neighbor(v, d);
+					if (u < 0) {
+						continue;
+					}
+					pair<cell, cell> e(cell(r, c), cell(u / w, u % w));
+					if (same_color(u, v)) {
+						if (group_color[find(v)] < 0) {
+							res.same.push_back(e);
+						}
+					}
+					else if (!compatible(u, v) || edges[v * 4 + d] == Edge::different) {
+						if (group_color[find(u)] < 0 || group_color[find(v)] < 0) {
+							res.different.push_back(e);
+						}
+					}
+				}
+			}
+		}
+		return res;
+	}
+
+private:
+	int find(int v) {
+		while (parent[v] != v) {
+			parent[v] = parent[parent[v]];
+			v = parent[v];
+		}
+		return v;
+	}
+
+	void unite(int a, int b) {
+		int ra = find(a);
+		int rb = find(b);
+		if (ra == rb) {
+			return;
+		}
+		if (group_color[ra] >= 0 && group_color[rb] >= 0 && group_color[ra] != group_color[rb]) {
+			contradiction = true;
+			return;
+		}
+		if (group_color[ra] < 0) {
+			group_color[ra] = group_color[rb];
+		}
+		parent[rb] = ra;
+	}
+
+	bool same_color(int a, int b) {
+		int ra = find(a);
+		int rb = find(b);
+		return ra == rb || (group_color[ra] >= 0 && group_color[ra] == group_color[rb]);
+	}
+
+	bool compatible(int a, int b) {
+		int ca = group_color[find(a)];
+		int cb = group_color[find(b)];
+		return ca < 0 || cb < 0 || ca == cb;
+	}
+
+	int neighbor(int v, int d) {
+		int r = v / w + dirs[d][0];
+		int c = v % w + dirs[d][1];
+		if (r < 0 || c < 0 || r >= h || c >= w || !live[r * w + c]) {
+			return -1;
+		}
+		return r * w + c;
+	}
+
+	void set_different(int v, int d) {
+		int u = neighbor(v, d);
+		edges[v * 4 + d] = Edge::different;
+		edges[u * 4 + (d ^ 1)] = Edge::different;
+	}
+
+	// Applies the degree rule to every cell once. Returns true if anything
+	// changed.
+	bool sweep() {
+		bool changed = false;
+		for (int v = 0; v < h * w && !contradiction; v++) {
+			if (!live[v]) {
+				continue;
+			}
+			int same = 0;
+			int maybe[4];
+			int num_maybe = 0;
+			for (int d = 0; d < 4; d++) {
+				int u = neighbor(v, d);
+				if (u < 0) {
+					continue;
+				}
+				if (same_color(u, v)) {
+					if (edges[v * 4 + d] == Edge::different) {
+						contradiction = true;
+					}
+					same++;
+				}
+				else if (edges[v * 4 + d] != Edge::different && compatible(u, v)) {
+					maybe[num_maybe++] = d;
+				}
+			}
+			if (same > need[v] || same + num_maybe < need[v]) {
+				contradiction = true;
+			}
+			else if (num_maybe > 0 && same == need[v]) {
+				for (int i = 0; i < num_maybe; i++) {
+					set_different(v, maybe[i]);
+				}
+				changed = true;
+			}
+			else if (num_maybe > 0 && same + num_maybe == need[v]) {
+				for (int i = 0; i < num_maybe; i++) {
+					unite(v, neighbor(v, maybe[i]));
+				}
+				changed = true;
+			}
+		}
+		return changed;
+	}
+};
+
+}
+
+PreprocessResult preprocess(const board& b) {
+	return Preprocessor(b).run(b);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Board.hpp"
+
+#include <vector>
+#include <utility>
+
+// Deductions made from the board alone, before any search. Every cell on a
+// solved board has exactly two same-colored neighbors (one for endpoints), so
+// a cell whose possible partners are down to what it needs is forced to share
+// their color, and a cell that already has its partners cannot share a color
+// with any other neighbor. This covers corners, 1-wide corridors and
+// endpoints with a single free neighbor.
+struct PreprocessResult {
+	board colors;                        // Input board with every resolved cell filled in, holes kept
+	std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> same;       // Adjacent cells of equal but still unknown color
+	std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> different;  // Adjacent cells that cannot share a color
+	int resolved = 0;                    // Non-endpoint cells whose color was deduced
+	int free_cells = 0;                  // Non-endpoint cells on the board
+	bool contradiction = false;          // The board has no solution
+};
+
+PreprocessResult preprocess(const board& b);
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "SatBackend.hpp"
+
+#include <minisat/simp/SimpSolver.h>
+
+namespace {
+
+// Both Minisat solvers share everything but how they solve
+template <class S>
+class MinisatBackend : public SatBackend {
+private:
+	S solver;
+
+public:
+	Minisat::Var new_var(bool decision) override {
+		return solver.newVar(true, decision);
+	}
+
+	void set_activity(Minisat::Var v, double activity) override {
+		solver.setActivity(v, activity);
+	}
+
+	bool add_clause(const Minisat::vec<Minisat::Lit>& lits) override {
+		return solver.addClause(lits);
+	}
+
+	void set_limits(int64_t conflicts, int64_t propagations, uint64_t memory_bytes) override {
+		// Budgets are absolute counts: clear what an earlier call left
+		solver.budgetOff();
+		if (conflicts >= 0) {
+			solver.setConfBudget(conflicts);
+		}
+		if (propagations >= 0) {
+			solver.setPropBudget(propagations);
+		}
+		solver.setMemLimit(memory_bytes);
+	}
+
+	void set_progress_callback(std::function<void()> callback) override {
+		solver.progress_callback = callback;
+	}
+
+	Minisat::lbool solve(const Minisat::vec<Minisat::Lit>& assumptions) override;
+
+	void failed_assumptions(Minisat::vec<Minisat::Lit>& out) override {
+		solver.conflict.copyTo(out);
+	}
+
+	void freeze(Minisat::Var v) override;
+
+	bool memory_exhausted() override {
+		return solver.memLimitReached();
+	}
+
+	void interrupt() override {
+		solver.interrupt();
+	}
+
+	void clear_interrupt() override {
+		solver.clearInterrupt();
+	}
+
+	Minisat::lbool model_value(Minisat::Var v) override {
+		return solver.modelValue(v);
+	}
+
+	Minisat::lbool fixed_value(Minisat::Var v) override {
+		return solver.fixedValue(v);
+	}
+
+	SatStats stats() override {
+		SatStats res;
+		res.vars = solver.nVars();
+		res.clauses = solver.nClauses();
+		res.literals = solver.clauses_literals;
+		res.decisions = solver.decisions;
+		res.conflicts = solver.conflicts;
+		res.propagations = solver.propagations;
+		res.restarts = solver.starts;
+		res.learnts = solver.nLearnts();
+		res.progress = solver.progress();
+		return res;
+	}
+};
+
+template <>
+Minisat::lbool MinisatBackend<Minisat::Solver>::solve(const Minisat::vec<Minisat::Lit>& assumptions) {
+	return solver.solveLimited(assumptions);
+}
+
+template <>
+Minisat::lbool MinisatBackend<Minisat::SimpSolver>::solve(const Minisat::vec<Minisat::Lit>& assumptions) {
+	return solver.solveLimited(assumptions, true, true);
+}
+
+template <>
+void MinisatBackend<Minisat::Solver>::freeze(Minisat::Var) {
+}
+
+template <>
+void MinisatBackend<Minisat::SimpSolver>::freeze(Minisat::Var v) {
+	solver.setFrozen(v, true);
+}
+
+}
+
+bool SatBackend::add_clause(Minisat::Lit p) {
+	tmp.clear();
+	tmp.push(p);
+	return add_clause(tmp);
+}
+
+bool SatBackend::add_clause(Minisat::Lit p, Minisat::Lit q) {
+	tmp.clear();
+	tmp.push(p);
+	tmp.push(q);
+	return add_clause(tmp);
+}
+
+bool SatBackend::add_clause(Minisat::Lit p, Minisat::Lit q, Minisat::Lit r) {
+	tmp.clear();
+	tmp.push(p);
+	tmp.push(q);
+	tmp.push(r);
+	return add_clause(tmp);
+}
+
+bool SatBackend::add_empty_clause() {
+	tmp.clear();
+	return add_clause(tmp);
+}
+
+std::unique_ptr<SatBackend> make_minisat_backend(bool simplify) {
+	if (simplify) {
+		return std::unique_ptr<SatBackend>(new MinisatBackend<Minisat::SimpSolver>());
+	}
+	return std::unique_ptr<SatBackend>(new MinisatBackend<Minisat::Solver>());
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <minisat/core/Solver.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Search statistics of a SatBackend
+struct SatStats {
+	uint64_t vars = 0;
+	uint64_t clauses = 0;
+	uint64_t literals = 0;
+	uint64_t decisions = 0;
+	uint64_t conflicts = 0;
+	uint64_t propagations = 0;
+	uint64_t restarts = 0;
+	uint64_t learnts = 0;
+	double progress = 0;  // Estimate of the search space covered, 0 to 1
+};
+
+// The SAT solver that Solver hands its encoding to. Variables and literals
+// are Minisat's, numbered from 0 in the order new_var() creates them.
+class SatBackend {
+private:
+	Minisat::vec<Minisat::Lit> tmp;
+
+public:
+	virtual ~SatBackend() {}
+
+	virtual Minisat::Var new_var(bool decision) = 0;
+	// Initial activity for the decision heuristic
+	virtual void set_activity(Minisat::Var v, double activity) = 0;
+	// Returns false once the clauses are known to be unsatisfiable
+	virtual bool add_clause(const Minisat::vec<Minisat::Lit>& lits) = 0;
+	bool add_clause(Minisat::Lit p);
+	bool add_clause(Minisat::Lit p, Minisat::Lit q);
+	bool add_clause(Minisat::Lit p, Minisat::Lit q, Minisat::Lit r);
+	bool add_empty_clause();
+
+	// -1 for no conflict or propagation limit, 0 for no memory limit
+	virtual void set_limits(int64_t conflicts, int64_t propagations, uint64_t memory_bytes) = 0;
+	// Called every few conflicts while solving
+	virtual void set_progress_callback(std::function<void()> callback) = 0;
+	// Solves with the assumptions as temporary unit clauses; l_Undef if a
+	// limit was hit or the search was interrupted
+	virtual Minisat::lbool solve(const Minisat::vec<Minisat::Lit>& assumptions) = 0;
+	// After solve() returned l_False: the negations of assumptions that are
+	// enough for the contradiction, empty if the clauses alone are
+	virtual void failed_assumptions(Minisat::vec<Minisat::Lit>& out) = 0;
+	// Keeps v out of variable elimination, so it can be assumed later
+	virtual void freeze(Minisat::Var v) = 0;
+	virtual bool memory_exhausted() = 0;
+	// Safe to call from any thread
+	virtual void interrupt() = 0;
+	virtual void clear_interrupt() = 0;
+
+	// Value in the model found by the last successful solve()
+	virtual Minisat::lbool model_value(Minisat::Var v) = 0;
+	// Value fixed at decision level 0, l_Undef if none; safe to call from the
+	// progress callback
+	virtual Minisat::lbool fixed_value(Minisat::Var v) = 0;
+	virtual SatStats stats() = 0;
+};
+
+// Minisat's core solver, or its SimpSolver, which eliminates variables
+// before the search and extends the model afterwards.
+std::unique_ptr<SatBackend> make_minisat_backend(bool simplify);
@@ -0,0 +1,403 @@
+#include "SolutionCache.hpp"
+#include "SolutionCode.hpp"
+#include "Symmetry.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::vector;
+using std::pair;
+
+namespace {
+
+const char magic[8] = { 'F', 'F', 'C', 'A', 'C', 'H', 'E', '2' };
+
+struct Header {
+	char magic[8];
+	uint64_t slots;
+	uint64_t data_offset;  // Start of the data area
+	uint64_t clock;        // Last use counter for LRU
+};
+
+enum : uint32_t {
+	slot_empty = 0,
+	slot_used = 1,
+	slot_deleted = 2
+};
+
+struct Entry {
+	uint64_t key;
+	uint64_t last_used;
+	uint64_t offset;
+	uint32_t length;
+	uint32_t state;
+};
+
+// Records start with rows and cols (32 bits each), the result and the bits
+// per cell, followed by the board with every cell stored as value + 2 (holes
+// are 0, empty cells 1), then the solution: its code (see SolutionCode.hpp)
+// or, for solutions without one, its cells like the board's. A solution
+// without a code has a detached loop, which --acyclic rules out; for the
+// same reason a board may be unsolvable with --acyclic but not without.
+enum : uint8_t {
+	record_solved = 0,            // Solution cells
+	record_unsolvable = 1,        // Even with detached loops
+	record_solved_code = 2,       // Solution code
+	record_unsolvable_paths = 3   // Without detached loops
+};
+const uint64_t record_header_size = 10;
+// A slot per this many bytes of file
+const uint64_t bytes_per_slot = 2048;
+
+int cell_bits(const board& b, const board& solution) {
+	int max_value = 1;
+	for (const board* cur : { &b, &solution }) {
+		for (auto& row : *cur) {
+			for (int value : row) {
+				max_value = std::max(max_value, value + 2);
+			}
+		}
+	}
+	int bits = 1;
+	while ((1 << bits) <= max_value) {
+		bits++;
+	}
+	return bits;
+}
+
+void pack(const board& b, int bits, vector<uint8_t>& out) {
+	uint64_t acc = 0;
+	int filled = 0;
+	for (auto& row : b) {
+		for (int value : row) {
+			acc |= (uint64_t)(value + 2) << filled;
+			filled += bits;
+			while (filled >= 8) {
+				out.push_back(acc & 0xff);
+				acc >>= 8;
+				filled -= 8;
+			}
+		}
+	}
+	if (filled > 0) {
+		out.push_back(acc & 0xff);
+	}
+}
+
+// Reads rows x cols cells starting at data; returns the bytes consumed
+uint64_t unpack(const uint8_t* data, int rows, int cols, int bits, board& b) {
+	b.assign(rows, vector<int>(cols));
+	uint64_t acc = 0;
+	int filled = 0;
+	uint64_t pos = 0;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			while (filled < bits) {
+				acc |= (uint64_t)data[pos++] << filled;
+				filled += 8;
+			}
+			b[r][c] = (int)(acc & ((1u << bits) - 1)) - 2;
+			acc >>= bits;
+			filled -= bits;
+		}
+	}
+	return pos;
+}
+
+// Whether solving with these options rules out detached loops, or some of
+// them: an unsolvable result then says nothing about boards solvable only
+// with a loop. The native backend only grows paths, and a 2x2 block of one
+// color is always a detached 4-cycle, so --block-clauses rules those out.
+bool paths_only(const SolverOptions& options) {
+	return options.acyclic != Acyclicity::none || options.backend == Backend::native || options.block_clauses;
+}
+
+void encode_record(const board& b, SolveResult result, bool paths, const board& solution, vector<uint8_t>& out) {
+	uint32_t rows = b.size();
+	uint32_t cols = b.empty() ? 0 : b[0].size();
+	vector<uint8_t> code;
+	bool coded = result == SolveResult::solved && encode_solution(b, solution, code);
+	int bits = coded || result != SolveResult::solved ? cell_bits(b, b) : cell_bits(b, solution);
+	out.resize(record_header_size);
+	memcpy(out.data(), &rows, 4);
+	memcpy(out.data() + 4, &cols, 4);
+	out[8] = result != SolveResult::solved ? (paths ? record_unsolvable_paths : record_unsolvable) : coded ? record_solved_code : record_solved;
+	out[9] = bits;
+	pack(b, bits, out);
+	if (coded) {
+		out.insert(out.end(), code.begin(), code.end());
+	}
+	else if (result == SolveResult::solved) {
+		pack(solution, bits, out);
+	}
+}
+
+#ifndef _WIN32
+class FileLock {
+private:
+	int fd;
+
+public:
+	FileLock(int fd, int mode) : fd(fd) {
+		while (flock(fd, mode) != 0) {
+			if (errno != EINTR) {
+				throw std::runtime_error("Error: could not lock the solution cache");
+			}
+		}
+	}
+	~FileLock() {
+		flock(fd, LOCK_UN);
+	}
+};
+#endif
+
+}
+
+uint64_t board_hash(const board& b) {
+	// 64-bit FNV-1a over the dimensions and every cell
+	uint64_t h = 14695981039346656037ull;
+	auto mix = [&h](uint32_t value) {
+		for (int i = 0; i < 4; i++) {
+			h ^= (value >> (8 * i)) & 0xff;
+			h *= 1099511628211ull;
+		}
+	};
+	mix(b.size());
+	mix(b.empty() ? 0 : b[0].size());
+	for (auto& row : b) {
+		for (int value : row) {
+			mix(value);
+		}
+	}
+	return h;
+}
+
+#ifdef _WIN32
+
+SolutionCache::SolutionCache(const std::string& path, int size_mb) {
+	throw std::runtime_error("Error: the solution cache is not supported on this platform");
+}
+
+SolutionCache::~SolutionCache() {
+}
+
+bool SolutionCache::find(const board& b, const SolverOptions& options, SolveResult& result, board& solution) {
+	return false;
+}
+
+void SolutionCache::insert(const board& b, const SolverOptions& options, SolveResult result, const board& solution) {
+}
+
+#else
+
+SolutionCache::SolutionCache(const std::string& path, int size_mb) {
+	fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		throw std::runtime_error("Error: could not open solution cache " + path);
+	}
+	{
+		// Whoever gets here first lays out the file
+		FileLock lock(fd, LOCK_EX);
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			close(fd);
+			throw std::runtime_error("Error: could not read solution cache " + path);
+		}
+		size = st.st_size;
+		if (size == 0) {
+			size = (uint64_t)size_mb << 20;
+			Header h;
+			memcpy(h.magic, magic, sizeof(magic));
+			h.slots = std::max<uint64_t>(size / bytes_per_slot, 16);
+			h.data_offset = sizeof(Header) + h.slots * sizeof(Entry);
+			h.clock = 0;
+			if (ftruncate(fd, size) != 0 || pwrite(fd, &h, sizeof(h), 0) != sizeof(h)) {
+				close(fd);
+				throw std::runtime_error("Error: could not create solution cache " + path);
+			}
+		}
+	}
+	memory = (uint8_t*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (memory == MAP_FAILED) {
+		close(fd);
+		throw std::runtime_error("Error: could not map solution cache " + path);
+	}
+	Header* h = (Header*)memory;
+	if (size < sizeof(Header) || memcmp(h->magic, magic, sizeof(magic)) != 0 || h->data_offset > size) {
+		munmap(memory, size);
+		close(fd);
+		throw std::runtime_error("Error: " + path + " is not a solution cache");
+	}
+}
+
+SolutionCache::~SolutionCache() {
+	munmap(memory, size);
+	close(fd);
+}
+
+bool SolutionCache::find(const board& original, const SolverOptions& options, SolveResult& result, board& solution) {
+	BoardTransform transform;
+	board b = canonicalize(original, transform);
+	FileLock lock(fd, LOCK_SH);
+	Header* h = (Header*)memory;
+	Entry* index = (Entry*)(memory + sizeof(Header));
+	uint32_t rows = b.size();
+	uint32_t cols = b.empty() ? 0 : b[0].size();
+	uint64_t key = board_hash(b);
+	for (uint64_t i = 0; i < h->slots; i++) {
+		Entry& e = index[(key + i) % h->slots];
+		if (e.state == slot_empty) {
+			return false;
+		}
+		if (e.state != slot_used || e.key != key) {
+			continue;
+		}
+		// Hash collisions: compare dimensions, then the board itself
+		const uint8_t* data = memory + e.offset;
+		if (memcmp(data, &rows, 4) != 0 || memcmp(data + 4, &cols, 4) != 0) {
+			continue;
+		}
+		int bits = data[9];
+		board stored;
+		uint64_t used = unpack(data + record_header_size, rows, cols, bits, stored);
+		if (stored != b) {
+			continue;
+		}
+		// Results that need or allow detached loops when the options do not
+		// count as misses; solving again replaces them
+		bool paths = paths_only(options);
+		if ((paths && data[8] == record_solved) || (!paths && data[8] == record_unsolvable_paths)) {
+			return false;
+		}
+		result = data[8] == record_unsolvable || data[8] == record_unsolvable_paths ? SolveResult::unsolvable : SolveResult::solved;
+		if (data[8] == record_solved_code) {
+			solution = undo_transform(decode_solution(stored, data + record_header_size + used, e.length - record_header_size - used), transform);
+		}
+		else if (data[8] == record_solved) {
+			board stored_solution;
+			unpack(data + record_header_size + used, rows, cols, bits, stored_solution);
+			solution = undo_transform(stored_solution, transform);
+		}
+		// Several readers may touch entries at once under the shared lock
+		uint64_t now = __atomic_add_fetch(&h->clock, 1, __ATOMIC_RELAXED);
+		__atomic_store_n(&e.last_used, now, __ATOMIC_RELAXED);
+		return true;
+	}
+	return false;
+}
+
+void SolutionCache::insert(const board& original, const SolverOptions& options, SolveResult result, const board& solution) {
+	if (result != SolveResult::solved && result != SolveResult::unsolvable) {
+		return;
+	}
+	BoardTransform transform;
+	board b = canonicalize(original, transform);
+	vector<uint8_t> record;
+	encode_record(b, result, paths_only(options), result == SolveResult::solved ? apply_transform(solution, transform) : solution, record);
+	FileLock lock(fd, LOCK_EX);
+	Header* h = (Header*)memory;
+	Entry* index = (Entry*)(memory + sizeof(Header));
+	if (record.size() > size - h->data_offset) {
+		return;
+	}
+	uint64_t key = board_hash(b);
+	auto evict_lru = [&]() {
+		Entry* lru = nullptr;
+		for (uint64_t i = 0; i < h->slots; i++) {
+			if (index[i].state == slot_used && (!lru || index[i].last_used < lru->last_used)) {
+				lru = &index[i];
+			}
+		}
+		lru->state = slot_deleted;
+	};
+
+	// Lookups probe up to the first empty slot. Once deletions have left few
+	// of those, rebuild the index from the used slots, dropping the least
+	// recently used ones if the index is nearly full.
+	uint64_t empty = 0;
+	for (uint64_t i = 0; i < h->slots; i++) {
+		empty += index[i].state == slot_empty;
+	}
+	if (empty < h->slots / 8) {
+		vector<Entry> live;
+		for (uint64_t i = 0; i < h->slots; i++) {
+			if (index[i].state == slot_used) {
+				live.push_back(index[i]);
+			}
+		}
+		std::sort(live.begin(), live.end(), [](const Entry& a, const Entry& b) { return a.last_used > b.last_used; });
+		live.resize(std::min<uint64_t>(live.size(), h->slots * 3 / 4));
+		memset(index, 0, h->slots * sizeof(Entry));
+		for (auto& entry : live) {
+			uint64_t i = entry.key % h->slots;
+			while (index[i].state != slot_empty) {
+				i = (i + 1) % h->slots;
+			}
+			index[i] = entry;
+		}
+	}
+
+	// A slot in the index, replacing older records with the same key
+	Entry* slot = nullptr;
+	while (!slot) {
+		for (uint64_t i = 0; i < h->slots; i++) {
+			Entry& e = index[(key + i) % h->slots];
+			if (e.state == slot_used && e.key == key) {
+				e.state = slot_deleted;
+			}
+			if (e.state != slot_used && !slot) {
+				slot = &e;
+			}
+			if (e.state == slot_empty) {
+				break;
+			}
+		}
+		if (!slot) {
+			evict_lru();
+		}
+	}
+
+	// First gap in the data area that fits the record
+	uint64_t offset = 0;
+	while (!offset) {
+		vector<pair<uint64_t, uint64_t>> used;
+		for (uint64_t i = 0; i < h->slots; i++) {
+			if (index[i].state == slot_used) {
+				used.push_back(pair<uint64_t, uint64_t>(index[i].offset, index[i].offset + index[i].length));
+			}
+		}
+		std::sort(used.begin(), used.end());
+		used.push_back(pair<uint64_t, uint64_t>(size, size));
+		uint64_t start = h->data_offset;
+		for (auto& range : used) {
+			if (range.first - start >= record.size()) {
+				offset = start;
+				break;
+			}
+			start = range.second;
+		}
+		if (!offset) {
+			evict_lru();
+		}
+	}
+
+	// Data first, so a crash never leaves a used slot pointing at garbage
+	memcpy(memory + offset, record.data(), record.size());
+	slot->key = key;
+	slot->offset = offset;
+	slot->length = record.size();
+	slot->last_used = ++h->clock;
+	__atomic_store_n(&slot->state, (uint32_t)slot_used, __ATOMIC_RELEASE);
+}
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Solver.hpp"
+
+#include <cstdint>
+#include <string>
+
+// Results of earlier solves kept in a memory-mapped file, keyed by a hash of
+// the canonical form of the board (see canonicalize()), so rotated, reflected
+// and recolored copies of a board share one record. The file holds a fixed-size header, an open-addressing index and
+// a data area with one record per board (the board itself, to rule out hash
+// collisions, bit-packed, and its solution, two bits per cell as
+// encode_solution() writes it, or bit-packed if it has no code). The file never grows past
+// the size it was created with; when a record does not fit, the least
+// recently used ones are evicted. Processes sharing the file serialize
+// through flock(): lookups take a shared lock, inserts an exclusive one.
+//
+// Only solved and unsolvable results are stored. Not available on Windows.
+class SolutionCache {
+private:
+	int fd = -1;
+	uint8_t* memory = nullptr;
+	uint64_t size = 0;
+
+public:
+	// Opens the cache at path, creating it with size_mb megabytes if it does
+	// not exist. An existing file keeps its size. Throws on I/O errors.
+	SolutionCache(const std::string& path, int size_mb);
+	~SolutionCache();
+	SolutionCache(const SolutionCache&) = delete;
+	SolutionCache& operator=(const SolutionCache&) = delete;
+
+	// Returns true and fills in result (and solution, if solved) if b, or a
+	// board equivalent to it, is in the cache with a result that holds for
+	// options: records say whether detached loops were allowed (see
+	// SolverOptions::acyclic), and only matching ones are returned.
+	bool find(const board& b, const SolverOptions& options, SolveResult& result, board& solution);
+	// options are the ones result was found with
+	void insert(const board& b, const SolverOptions& options, SolveResult result, const board& solution);
+};
+
+// Stable across platforms and runs, unlike std::hash
+uint64_t board_hash(const board& b);
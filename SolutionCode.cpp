@@ -0,0 +1,208 @@
+#include "SolutionCode.hpp"
+
+#include <stdexcept>
+
+using std::vector;
+
+namespace {
+
+const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Endpoints of each color as r * cols + c, first the one that comes first in
+// row-major order. Returns false unless every color has two.
+bool find_endpoints(const board& b, int cols, vector<int>& first, vector<int>& last) {
+	for (int r = 0; r < (int)b.size(); r++) {
+		for (int c = 0; c < cols; c++) {
+			int color = b[r][c];
+			if (color < 0) {
+				continue;
+			}
+			if (color >= (int)first.size()) {
+				first.resize(color + 1, -1);
+				last.resize(color + 1, -1);
+			}
+			if (first[color] < 0) {
+				first[color] = r * cols + c;
+			}
+			else if (last[color] < 0) {
+				last[color] = r * cols + c;
+			}
+			else {
+				return false;
+			}
+		}
+	}
+	for (int v : last) {
+		if (v < 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+std::size_t solution_code_size(int rows, int cols) {
+	return ((std::size_t)rows * cols + 3) / 4;
+}
+
+bool encode_solution(const board& b, const board& solution, vector<uint8_t>& code) {
+	int rows = b.size();
+	int cols = b.empty() ? 0 : b[0].size();
+	if (solution.size() != b.size()) {
+		return false;
+	}
+	int live = 0;
+	for (int r = 0; r < rows; r++) {
+		if ((int)b[r].size() != cols || (int)solution[r].size() != cols) {
+			return false;
+		}
+		for (int c = 0; c < cols; c++) {
+			int value = b[r][c];
+			if ((value == hole) != (solution[r][c] == hole) || (value >= 0 && solution[r][c] != value)) {
+				return false;
+			}
+			live += value != hole;
+		}
+	}
+	vector<int> first;
+	vector<int> last;
+	if (!find_endpoints(b, cols, first, last)) {
+		return false;
+	}
+
+	code.assign(solution_code_size(rows, cols), 0);
+	int walked = 0;
+	for (int color = 0; color < (int)first.size(); color++) {
+		int r = first[color] / cols;
+		int c = first[color] % cols;
+		int from = -1;
+		while (true) {
+			walked++;
+			// Exactly one way on, except at the end of the path
+			int next = -1;
+			for (int d = 0; d < 4; d++) {
+				int nr = r + dirs[d][0];
+				int nc = c + dirs[d][1];
+				if (nr < 0 || nc < 0 || nr >= rows || nc >= cols || solution[nr][nc] != color || nr * cols + nc == from) {
+					continue;
+				}
+				if (next >= 0) {
+					return false;
+				}
+				next = d;
+			}
+			int v = r * cols + c;
+			if (v == last[color]) {
+				if (next >= 0) {
+					return false;
+				}
+				break;
+			}
+			if (next < 0 || walked > live) {
+				return false;
+			}
+			code[v >> 2] |= next << ((v & 3) * 2);
+			from = v;
+			r += dirs[next][0];
+			c += dirs[next][1];
+		}
+	}
+	// Cells no path went through are detached loops
+	return walked == live;
+}
+
+board decode_solution(const board& b, const uint8_t* code, std::size_t size) {
+	int rows = b.size();
+	int cols = b.empty() ? 0 : b[0].size();
+	if (size < solution_code_size(rows, cols)) {
+		throw std::runtime_error("Error: the solution code is too short for the board");
+	}
+	vector<int> first;
+	vector<int> last;
+	if (!find_endpoints(b, cols, first, last)) {
+		throw std::runtime_error("Error: the board does not have two endpoints of every color");
+	}
+	board res = b;
+	int empty = 0;
+	for (auto& row : b) {
+		for (int value : row) {
+			empty += value == -1;
+		}
+	}
+	for (int color = 0; color < (int)first.size(); color++) {
+		int v = first[color];
+		int r = v / cols;
+		int c = v % cols;
+		while (v != last[color]) {
+			int d = (code[v >> 2] >> ((v & 3) * 2)) & 3;
+			r += dirs[d][0];
+			c += dirs[d][1];
+			v = r * cols + c;
+			if (r < 0 || c < 0 || r >= rows || c >= cols || (res[r][c] != -1 && v != last[color])) {
+				throw std::runtime_error("Error: the solution code does not fit the board");
+			}
+			if (v != last[color]) {
+				res[r][c] = color;
+				empty--;
+			}
+		}
+	}
+	if (empty != 0) {
+		throw std::runtime_error("Error: the solution code leaves cells empty");
+	}
+	return res;
+}
+
+std::string solution_code_to_string(const vector<uint8_t>& code) {
+	std::string res;
+	res.reserve((code.size() * 4 + 2) / 3);
+	uint32_t acc = 0;
+	int filled = 0;
+	for (uint8_t byte : code) {
+		acc = (acc << 8) | byte;
+		filled += 8;
+		while (filled >= 6) {
+			filled -= 6;
+			res += base64[(acc >> filled) & 63];
+		}
+	}
+	if (filled > 0) {
+		res += base64[(acc << (6 - filled)) & 63];
+	}
+	return res;
+}
+
+vector<uint8_t> solution_code_from_string(const std::string& text) {
+	vector<uint8_t> res;
+	res.reserve(text.size() * 3 / 4);
+	uint32_t acc = 0;
+	int filled = 0;
+	for (char ch : text) {
+		int value;
+		if (ch >= 'A' && ch <= 'Z') {
+			value = ch - 'A';
+		}
+		else if (ch >= 'a' && ch <= 'z') {
+			value = ch - 'a' + 26;
+		}
+		else if (ch >= '0' && ch <= '9') {
+			value = ch - '0' + 52;
+		}
+		else if (ch == '-' || ch == '_') {
+			value = ch == '-' ? 62 : 63;
+		}
+		else {
+			throw std::runtime_error("Error: invalid character in solution code: " + std::string(1, ch));
+		}
+		acc = (acc << 6) | value;
+		filled += 6;
+		if (filled >= 8) {
+			filled -= 8;
+			res.push_back((acc >> filled) & 0xff);
+		}
+	}
+	return res;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Board.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Solutions stored as directions instead of colors, two bits per cell. Each
+// color is walked from its first endpoint in row-major order to the other
+// one, and every cell on the way holds the direction of the next cell (0
+// down, 1 up, 2 right, 3 left). Holes and the last cell of each path hold 0.
+// Cells are packed four to a byte, row by row, lowest bits first. Decoding
+// needs the board: the colors come back from its endpoints.
+//
+// Only solutions made of paths have a code; one with a detached loop of some
+// color (possible without --acyclic) does not.
+
+// Bytes in the code of a rows x cols board
+std::size_t solution_code_size(int rows, int cols);
+
+// Fills in code and returns true if solution solves b (as verify_solution()
+// checks it); returns false otherwise, or if solution has a detached loop.
+bool encode_solution(const board& b, const board& solution, std::vector<uint8_t>& code);
+
+// The solution of b with this code. Throws if code is too short or its paths
+// leave the board, run into each other or miss cells.
+board decode_solution(const board& b, const uint8_t* code, std::size_t size);
+
+// The code as text for JSON and line records: URL-safe base64 without
+// padding, a character for every three cells.
+std::string solution_code_to_string(const std::vector<uint8_t>& code);
+// Throws on characters that are not URL-safe base64
+std::vector<uint8_t> solution_code_from_string(const std::string& text);
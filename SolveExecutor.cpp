@@ -0,0 +1,148 @@
+#include "SolveExecutor.hpp"
+#include "Decompose.hpp"
+#include "Watchdog.hpp"
+
+#include <algorithm>
+
+struct SolveTask {
+	board b;
+	SolverOptions options;
+	SolveCallback on_done;
+	std::chrono::steady_clock::time_point deadline;
+	std::promise<SolveOutcome> promise;
+	std::shared_future<SolveOutcome> outcome;
+	// Guards cancelled and watchdog, which only exists while the solve runs
+	std::mutex mutex;
+	bool cancelled = false;
+	Watchdog* watchdog = nullptr;
+};
+
+namespace {
+
+void cancel_task(SolveTask& task) {
+	std::lock_guard<std::mutex> lock(task.mutex);
+	task.cancelled = true;
+	if (task.watchdog) {
+		task.watchdog->cancel();
+	}
+}
+
+}
+
+SolveHandle::SolveHandle(std::shared_ptr<SolveTask> task, std::shared_future<SolveOutcome> outcome) : task(task), outcome(outcome) {
+}
+
+std::shared_future<SolveOutcome> SolveHandle::future() const {
+	return outcome;
+}
+
+bool SolveHandle::done() const {
+	return outcome.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void SolveHandle::cancel() {
+	cancel_task(*task);
+}
+
+SolveExecutor::SolveExecutor(int threads) {
+	if (threads <= 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (int i = 0; i < threads; i++) {
+		workers.push_back(std::thread(&SolveExecutor::run, this));
+	}
+}
+
+SolveExecutor::~SolveExecutor() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
+		// Queued solves are still handed out, so that every future gets ready
+		// and every callback runs
+		for (auto& task : queue) {
+			cancel_task(*task);
+		}
+		for (auto& task : running) {
+			cancel_task(*task);
+		}
+	}
+	wake.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+SolveHandle SolveExecutor::submit(const board& b, SolverOptions options, SolveCallback on_done, std::chrono::steady_clock::time_point deadline) {
+	auto task = std::make_shared<SolveTask>();
+	task->b = b;
+	task->options = options;
+	task->on_done = on_done;
+	task->deadline = deadline;
+	task->outcome = task->promise.get_future().share();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(task);
+	}
+	wake.notify_one();
+	return SolveHandle(task, task->outcome);
+}
+
+void SolveExecutor::run() {
+	while (true) {
+		std::shared_ptr<SolveTask> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]() { return stopped || !queue.empty(); });
+			if (queue.empty()) {
+				return;
+			}
+			task = queue.front();
+			queue.pop_front();
+			running.push_back(task);
+		}
+		execute(task);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running.erase(std::find(running.begin(), running.end(), task));
+		}
+	}
+}
+
+void SolveExecutor::execute(const std::shared_ptr<SolveTask>& task) {
+	// The earlier of the submit deadline and options.timeout
+	std::unique_ptr<Watchdog> watchdog;
+	{
+		std::lock_guard<std::mutex> lock(task->mutex);
+		if (!task->cancelled) {
+			auto deadline = task->deadline;
+			if (task->options.timeout > 0) {
+				auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(task->options.timeout));
+				deadline = std::min(deadline, std::chrono::steady_clock::now() + limit);
+			}
+			watchdog.reset(new Watchdog(deadline));
+			task->watchdog = watchdog.get();
+		}
+	}
+
+	SolveOutcome outcome = SolveOutcome();
+	try {
+		if (watchdog) {
+			outcome.result = solve_board(task->b, task->options, outcome.solution, outcome.stats, watchdog.get());
+		}
+		else {
+			outcome.result = SolveResult::indeterminate;
+		}
+		task->promise.set_value(outcome);
+	}
+	catch (...) {
+		task->promise.set_exception(std::current_exception());
+	}
+	{
+		std::lock_guard<std::mutex> lock(task->mutex);
+		task->watchdog = nullptr;
+	}
+	watchdog.reset();
+	if (task->on_done) {
+		task->on_done(SolveHandle(task, task->outcome));
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Solver.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SolveOutcome {
+	SolveResult result;
+	board solution;  // Only filled in if solved
+	SolverStats stats;
+};
+
+struct SolveTask;
+
+// A solve submitted to a SolveExecutor. Copies refer to the same solve.
+class SolveHandle {
+private:
+	std::shared_ptr<SolveTask> task;
+	std::shared_future<SolveOutcome> outcome;
+
+public:
+	SolveHandle(std::shared_ptr<SolveTask> task, std::shared_future<SolveOutcome> outcome);
+	// Ready once the solve is over. get() rethrows errors such as a board
+	// over the encoder budget.
+	std::shared_future<SolveOutcome> future() const;
+	bool done() const;
+	// Interrupts the search, or skips it if it has not started; the outcome
+	// is then indeterminate. Returns at once, safe to call from any thread
+	// and more than once.
+	void cancel();
+};
+
+using SolveCallback = std::function<void(SolveHandle)>;
+
+// Runs solve_board() on a fixed set of worker threads so that the caller
+// never blocks. Solves start in submission order as workers become free.
+class SolveExecutor {
+private:
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<std::shared_ptr<SolveTask>> queue;
+	std::vector<std::shared_ptr<SolveTask>> running;
+	bool stopped = false;
+	std::vector<std::thread> workers;
+
+public:
+	// threads = 0 for one per hardware thread
+	SolveExecutor(int threads = 0);
+	// Cancels every solve not yet finished and waits for the workers
+	~SolveExecutor();
+	SolveExecutor(const SolveExecutor&) = delete;
+	SolveExecutor& operator=(const SolveExecutor&) = delete;
+
+	// Queues b for solving. deadline bounds the whole solve, time spent in the
+	// queue included; options.timeout still counts from the start of the
+	// search, and whichever comes first stops it. on_done, if given, runs on
+	// the worker thread once the outcome is ready, including after cancel()
+	// or an error, and must not throw.
+	SolveHandle submit(const board& b, SolverOptions options, SolveCallback on_done = SolveCallback(),
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+private:
+	void run();
+	void execute(const std::shared_ptr<SolveTask>& task);
+};
@@ -1,25 +1,36 @@
 #include "Solver.hpp"
 #include "BoolExpr.hpp"
+#include "Cuts.hpp"
+#include "Preprocess.hpp"
+#include "Validate.hpp"
 
-#include <iostream>
 #include <string>
 #include <memory>
 #include <queue>
 #include <exception>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <mutex>
+#include <sstream>
 
 using std::string;
 using std::make_shared;
 using std::to_string;
 using std::shared_ptr;
-using std::cout;
 using std::endl;
+using std::vector;
+using std::pair;
+using std::queue;
+
+using cell = std::pair<int, int>;
 
 vector<vector<int>> combination(int n, int k);
 
 void Solver::tseitin(shared_ptr<BoolExpr> b) {
 	Minisat::Lit y_0 = makeVar();
-	solver.addClause(y_0);
+	backend->add_clause(y_0);
 	tseitin_helper(b, y_0);
 }
 
@@ -47,14 +58,14 @@ void Solver::tseitin_helper(shared_ptr<BoolExpr> b, Minisat::Lit cur) {
 		}
 
 		if (b->op == "&") {
-			solver.addClause(~cur, y_1);
-			solver.addClause(~cur, y_2);
-			solver.addClause(cur, ~y_1, ~y_2);
+			backend->add_clause(~cur, y_1);
+			backend->add_clause(~cur, y_2);
+			backend->add_clause(cur, ~y_1, ~y_2);
 		}
 		else if (b->op == "|") {
-			solver.addClause(cur, ~y_1);
-			solver.addClause(cur, ~y_2);
-			solver.addClause(~cur, y_1, y_2);
+			backend->add_clause(cur, ~y_1);
+			backend->add_clause(cur, ~y_2);
+			backend->add_clause(~cur, y_1, y_2);
 		}
 		else {
 			throw(std::runtime_error(b->op + " is not a valid operator"));
@@ -62,48 +73,561 @@ void Solver::tseitin_helper(shared_ptr<BoolExpr> b, Minisat::Lit cur) {
 	}
 }
 
-Solver::Solver() {
-	n = 0;
+Solver::Solver() : backend(make_minisat_backend(false)) {
+	rows = 0;
+	cols = 0;
 	num_colors = 0;
 }
 
-Solver::Solver(int n, unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> endpoints) : n(n) {
+Solver::Solver(const board& b, SolverOptions options) : Solver(b.size(), b.empty() ? 0 : b[0].size(), endpoints_from_board(b), options, board_region(b)) {
+}
+
+Solver::Solver(int rows, int cols, endpoint_map endpoints, SolverOptions options, Region region) : backend(make_minisat_backend(options.backend == Backend::simp)), options(options), region(region), rows(rows), cols(cols) {
+	if (options.backend == Backend::native) {
+		throw std::runtime_error("Error: the native backend does not use the CNF encoding");
+	}
+	validate_endpoints(endpoints);
 	num_colors = endpoints.size() / 2;
+	choose_encoding(endpoints.size());
 	init_vars();
+	free_cells = num_cells - endpoints.size();
+	restrict_to_region();
 	create_expression(endpoints);
+	acyclicity(endpoints);
+	board known = board_from_endpoints(rows, cols, endpoints);
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				known[r][c] = hole;
+			}
+		}
+	}
+	if (options.preprocess) {
+		PreprocessResult pre = preprocess(known);
+		add_deductions(pre);
+		known = pre.colors;
+	}
+	add_cut_constraints(known, endpoints);
+	seed_decision_order(endpoints);
+}
+
+// The region of a board with holes; boards without holes use the whole grid
+Region Solver::board_region(const board& b) {
+	Region res;
+	bool holes = false;
+	vector<vector<bool>> live;
+	for (auto& row : b) {
+		live.push_back(vector<bool>());
+		for (int value : row) {
+			live.back().push_back(value != hole);
+			holes |= value == hole;
+		}
+	}
+	if (holes) {
+		res.live = live;
+	}
+	return res;
+}
+
+void Solver::restrict_to_region() {
+	if (region.banned.empty()) {
+		return;
+	}
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (is_valid_space(r, c)) {
+				for (int color : region.banned[r][c]) {
+					backend->add_clause(~color_lit(r, c, color));
+				}
+			}
+		}
+	}
+}
+
+void Solver::choose_encoding(uint64_t endpoints) {
+	uint64_t cells = 0;
+	uint64_t edges = 0;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (is_valid_space(r, c)) {
+				cells++;
+				edges += is_valid_space(r + 1, c) + is_valid_space(r, c + 1);
+			}
+		}
+	}
+	uint64_t budget = (uint64_t)options.encoder_budget_mb << 20;
+	if (options.encoding == ColorEncoding::automatic) {
+		options.encoding = ColorEncoding::one_hot;
+		if (num_colors > 26 || estimate_size(cells, edges, endpoints, options).bytes() > budget) {
+			options.encoding = ColorEncoding::log;
+		}
+	}
+	uint64_t bytes = estimate_size(cells, edges, endpoints, options).bytes();
+	if (bytes > budget) {
+		throw std::runtime_error("Error: board needs about " + to_string(bytes >> 20) + " MB to encode, over the budget of " +
+			to_string(options.encoder_budget_mb) + " MB");
+	}
+}
+
+uint64_t InstanceSize::bytes() const {
+	// Per variable: assignment, reason, activity, heap and two watch lists.
+	// Per clause: header and two watchers.
+	return vars * 80 + clauses * 24 + literals * 4;
+}
+
+InstanceSize estimate_size(uint64_t cells, uint64_t edges, uint64_t endpoints, const SolverOptions& options) {
+	InstanceSize res;
+	uint64_t k = endpoints / 2;
+	uint64_t free = cells - endpoints;
+	uint64_t bits = 0;
+	while ((1ull << bits) < k) {
+		bits++;
+	}
+	if (options.encoding == ColorEncoding::log) {
+		// Bound and degree clauses per cell, equal_colors() per edge
+		res.vars = cells * bits + edges * (bits + 1);
+		res.clauses = cells * (bits + 8) + edges * (6 * bits + 1);
+		res.literals = cells * (bits * bits + 24) + edges * (19 * bits + 1);
+	}
+	else {
+		// Pairwise at-most-one per cell, and about 21 Tseitin auxiliaries
+		// with 3 clauses each per empty cell and color
+		res.vars = cells * k + free * k * 21;
+		res.clauses = cells * k * (k - 1) / 2 + free * k * 63 + endpoints * 8;
+		res.literals = cells * k * (k - 1) + free * k * 150 + endpoints * 16;
+	}
+	// One predecessor literal per direction of every edge
+	uint64_t preds = 2 * edges;
+	uint64_t channel = options.encoding == ColorEncoding::log ? 1 : k;
+	if (options.acyclic == Acyclicity::unary) {
+		res.vars += cells * cells + preds;
+		res.clauses += cells * cells + preds * (cells + channel);
+		res.literals += 2 * cells * cells + preds * (3 * cells + 3 * channel);
+	}
+	else if (options.acyclic == Acyclicity::binary) {
+		uint64_t rank_bits = 1;
+		while ((1ull << rank_bits) < cells) {
+			rank_bits++;
+		}
+		res.vars += cells * rank_bits + preds * (1 + 7 * rank_bits);
+		res.clauses += preds * (21 * rank_bits + channel);
+		res.literals += preds * (50 * rank_bits + 3 * channel);
+	}
+	return res;
 }
 
 void Solver::init_vars() {
+	init_layout();
+	if (options.encoding == ColorEncoding::log) {
+		color_bits = 0;
+		while ((1 << color_bits) < num_colors) {
+			color_bits++;
+		}
+		for (int i = 0; i < num_cells * color_bits; i++) {
+			makeVar(VarClass::cell);
+		}
+		return;
+	}
+	for (int i = 0; i < num_cells * num_colors; i++) {
+		makeVar(VarClass::cell);
+	}
+}
+
+Minisat::Lit Solver::makeVar(VarClass kind) {
+	bool decision = is_decision(kind);
+	backend->new_var(decision);
+	if (decision) {
+		num_decision_vars++;
+	}
+	return Minisat::mkLit(num_vars++);
+}
+
+bool Solver::is_decision(VarClass kind) {
+	switch (kind) {
+	case VarClass::cell:
+		return options.decide_cells;
+	case VarClass::aux:
+		return options.decide_aux;
+	case VarClass::order:
+		return options.decide_order;
+	}
+	return true;
+}
+
+void Solver::seed_decision_order(endpoint_map endpoints) {
+	// Orders are defined on the one-hot variables
+	if (options.order == DecisionOrder::vsids || options.encoding == ColorEncoding::log) {
+		return;
+	}
+	vector<vector<pair<int, int>>> color_endpoints(num_colors);
+	for (auto& endpoint : endpoints) {
+		color_endpoints[endpoint.second].push_back(endpoint.first);
+	}
+	// Seeded activities stay below 1 so the first few conflict bumps
+	// (var_inc starts at 1) override them.
+	double total = (double)num_colors * rows * cols;
 	for (int color = 0; color < num_colors; color++) {
-		for (int r = 0; r < n; r++) {
-			for (int c = 0; c < n; c++) {
-				makeVar();
+		for (int r = 0; r < rows; r++) {
+			for (int c = 0; c < cols; c++) {
+				if (!is_valid_space(r, c)) {
+					continue;
+				}
+				double activity;
+				if (options.order == DecisionOrder::color_major) {
+					activity = 1 - (color * rows * cols + r * cols + c) / total;
+				}
+				else {
+					int dist = rows + cols;
+					for (auto& endpoint : color_endpoints[color]) {
+						dist = std::min(dist, abs(endpoint.first - r) + abs(endpoint.second - c));
+					}
+					activity = 1.0 / (1 + dist);
+				}
+				backend->set_activity(to_var(r, c, color), activity);
 			}
 		}
 	}
 }
 
-Minisat::Lit Solver::makeVar() {
-	solver.newVar();
-	return Minisat::mkLit(num_vars++);
+void Solver::add_deductions(const PreprocessResult& pre) {
+	if (pre.contradiction) {
+		backend->add_empty_clause();
+		return;
+	}
+	fixed_cells = pre.resolved;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (pre.colors[r][c] >= 0) {
+				backend->add_clause(color_lit(r, c, pre.colors[r][c]));
+			}
+		}
+	}
+	if (options.encoding == ColorEncoding::log) {
+		for (auto& e : pre.same) {
+			backend->add_clause(edge_lit(e.first, e.second));
+		}
+		for (auto& e : pre.different) {
+			backend->add_clause(~edge_lit(e.first, e.second));
+		}
+		return;
+	}
+	for (auto& e : pre.same) {
+		for (int color = 0; color < num_colors; color++) {
+			Minisat::Lit a = color_lit(e.first.first, e.first.second, color);
+			Minisat::Lit b = color_lit(e.second.first, e.second.second, color);
+			backend->add_clause(~a, b);
+			backend->add_clause(a, ~b);
+		}
+	}
+	for (auto& e : pre.different) {
+		for (int color = 0; color < num_colors; color++) {
+			backend->add_clause(~color_lit(e.first.first, e.first.second, color), ~color_lit(e.second.first, e.second.second, color));
+		}
+	}
+}
+
+void Solver::add_cut_constraints(const board& known, endpoint_map endpoints) {
+	if (options.cuts == CutLevel::none) {
+		return;
+	}
+	CutConstraints cuts = find_cut_constraints(known, endpoints, options.cuts == CutLevel::pairs);
+	if (cuts.contradiction) {
+		backend->add_empty_clause();
+		return;
+	}
+	for (auto& unit : cuts.units) {
+		backend->add_clause(color_lit(unit.first.first, unit.first.second, unit.second));
+	}
+	for (auto& binary : cuts.binaries) {
+		cell u = binary.first.first;
+		cell v = binary.first.second;
+		backend->add_clause(color_lit(u.first, u.second, binary.second), color_lit(v.first, v.second, binary.second));
+	}
+}
+
+SolveResult Solver::solve() {
+	conflicts.clear();
+	return solve_assuming(Minisat::vec<Minisat::Lit>());
+}
+
+SolveResult Solver::solve(const board& hints) {
+	return solve_hinted(hints, Minisat::lit_Undef);
+}
+
+SolveResult Solver::solve_excluding(const board& hints, int r, int c, int color) {
+	if (!is_valid_space(r, c) || color < 0 || color >= num_colors) {
+		throw std::runtime_error("Error: cannot exclude color " + std::to_string(color) + " at row " + std::to_string(r + 1) + " column " + std::to_string(c + 1));
+	}
+	// Before color_lit(), whose channel clauses mention the bit variables
+	freeze_cells();
+	Minisat::Lit p = color_lit(r, c, color);
+	if (options.backend == Backend::simp) {
+		backend->freeze(Minisat::var(p));
+	}
+	return solve_hinted(hints, ~p);
+}
+
+void Solver::set_budget(int64_t conflicts, int64_t propagations) {
+	options.conflict_budget = conflicts;
+	options.propagation_budget = propagations;
+}
+
+// A cell's color is assumed through its one-hot variable, or through its
+// bits under the log encoding, never through a channel that elimination may
+// have removed. extra, if defined, is assumed as well.
+SolveResult Solver::solve_hinted(const board& hints, Minisat::Lit extra) {
+	if (hints.size() != rows || (rows && hints[0].size() != cols)) {
+		throw std::runtime_error("Error: hints do not have the size of the board");
+	}
+	freeze_cells();
+	Minisat::vec<Minisat::Lit> assumptions;
+	std::unordered_map<Minisat::Var, pair<int, int>> hinted;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			int color = hints[r][c];
+			if (color < 0) {
+				continue;
+			}
+			if (!is_valid_space(r, c) || color >= num_colors) {
+				throw std::runtime_error("Error: hint at row " + std::to_string(r + 1) + " column " + std::to_string(c + 1) + " is not a color of the board");
+			}
+			if (options.encoding == ColorEncoding::log) {
+				for (int i = 0; i < color_bits; i++) {
+					assumptions.push(Minisat::mkLit(bit_var(r, c, i), !((color >> i) & 1)));
+					hinted[bit_var(r, c, i)] = pair<int, int>(r, c);
+				}
+			}
+			else {
+				assumptions.push(Minisat::mkLit(to_var(r, c, color)));
+				hinted[to_var(r, c, color)] = pair<int, int>(r, c);
+			}
+		}
+	}
+	if (extra != Minisat::lit_Undef) {
+		assumptions.push(extra);
+	}
+	conflicts.clear();
+	SolveResult res = solve_assuming(assumptions);
+	if (res == SolveResult::unsolvable) {
+		Minisat::vec<Minisat::Lit> failed;
+		backend->failed_assumptions(failed);
+		for (int i = 0; i < failed.size(); i++) {
+			auto cell = hinted.find(Minisat::var(failed[i]));
+			if (cell != hinted.end()) {
+				conflicts.push_back(cell->second);
+			}
+		}
+		std::sort(conflicts.begin(), conflicts.end());
+		conflicts.erase(std::unique(conflicts.begin(), conflicts.end()), conflicts.end());
+	}
+	return res;
+}
+
+// Keeps the cell variables (the bits under the log encoding) out of
+// elimination, so they can be assumed and new channels can refer to them
+void Solver::freeze_cells() {
+	if (options.backend == Backend::simp && !cells_frozen) {
+		for (int v = 0; v < num_cells * (options.encoding == ColorEncoding::log ? color_bits : num_colors); v++) {
+			backend->freeze(v);
+		}
+		cells_frozen = true;
+	}
+}
+
+vector<pair<int, int>> Solver::conflicting_hints() {
+	return conflicts;
+}
+
+SolveResult Solver::solve_assuming(const Minisat::vec<Minisat::Lit>& assumptions) {
+	backend->set_limits(options.conflict_budget, options.propagation_budget, (uint64_t)options.memory_limit_mb << 20);
+	if (options.progress != ProgressFormat::none && options.progress_output) {
+		solve_start = last_report = std::chrono::steady_clock::now();
+		last_conflicts = backend->stats().conflicts;
+		backend->set_progress_callback([this]() { report_progress(); });
+	}
+	Minisat::lbool res = backend->solve(assumptions);
+	if (res.isTrue()) {
+		return SolveResult::solved;
+	}
+	if (res.isFalse()) {
+		return SolveResult::unsolvable;
+	}
+	return backend->memory_exhausted() ? SolveResult::out_of_memory : SolveResult::indeterminate;
+}
+
+void Solver::interrupt() {
+	backend->interrupt();
+}
+
+void Solver::clear_interrupt() {
+	backend->clear_interrupt();
+}
+
+// Called by Minisat every few conflicts; prints at most once per
+// progress_interval.
+void Solver::report_progress() {
+	auto now = std::chrono::steady_clock::now();
+	double since_last = std::chrono::duration<double>(now - last_report).count();
+	if (since_last < options.progress_interval) {
+		return;
+	}
+	double elapsed = std::chrono::duration<double>(now - solve_start).count();
+	SatStats st = backend->stats();
+	double rate = (st.conflicts - last_conflicts) / since_last;
+	last_report = now;
+	last_conflicts = st.conflicts;
+	int fixed = count_fixed_cells();
+
+	std::ostringstream line;
+	if (options.progress == ProgressFormat::json) {
+		line << "{\"time\":" << elapsed << ",\"conflicts\":" << st.conflicts << ",\"conflicts_per_sec\":" << rate
+			<< ",\"restarts\":" << st.restarts << ",\"learnts\":" << st.learnts << ",\"progress\":" << st.progress
+			<< ",\"fixed_cells\":" << fixed << ",\"free_cells\":" << free_cells << "}" << endl;
+	}
+	else {
+		line << "[progress] " << elapsed << "s conflicts " << st.conflicts << " (" << (uint64_t)rate << "/s) restarts " << st.restarts
+			<< " learnts " << st.learnts << " search " << 100 * st.progress << "% fixed " << fixed << "/" << free_cells << endl;
+	}
+	// Regions solved in parallel share the output
+	static std::mutex output;
+	std::lock_guard<std::mutex> lock(output);
+	options.progress_output(line.str());
+}
+
+// Non-endpoint cells whose color is fixed at decision level 0
+int Solver::count_fixed_cells() {
+	int fixed = 0;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				continue;
+			}
+			bool known = options.encoding == ColorEncoding::log;
+			for (int i = 0; i < color_bits && options.encoding == ColorEncoding::log; i++) {
+				Minisat::lbool value = backend->fixed_value(bit_var(r, c, i));
+				known &= value.isTrue() || value.isFalse();
+			}
+			for (int color = 0; color < num_colors && options.encoding == ColorEncoding::one_hot && !known; color++) {
+				known = backend->fixed_value(to_var(r, c, color)).isTrue();
+			}
+			fixed += known;
+		}
+	}
+	// Endpoints are fixed by unit clauses
+	return fixed - (num_cells - free_cells);
 }
 
-bool Solver::solve() {
-	return solver.solve();
+SolverStats Solver::stats() {
+	SatStats st = backend->stats();
+	SolverStats res;
+	res.vars = st.vars;
+	res.decision_vars = num_decision_vars;
+	res.clauses = st.clauses;
+	res.literals = st.literals;
+	res.decisions = st.decisions;
+	res.conflicts = st.conflicts;
+	res.propagations = st.propagations;
+	res.fixed_cells = fixed_cells;
+	res.free_cells = free_cells;
+	return res;
 }
 
 Minisat::Var Solver::to_var(int r, int c, int color) {
-	return c + r * n + color * pow(n, 2);
+	if (options.layout == VarLayout::color_major) {
+		return cell_order[r * cols + c] + color * num_cells;
+	}
+	return cell_order[r * cols + c] * num_colors + color;
+}
+
+Minisat::Var Solver::bit_var(int r, int c, int i) {
+	return cell_order[r * cols + c] * color_bits + i;
+}
+
+// Position of every cell in the variable numbering, -1 for cells outside the
+// region. Morton (Z-order) keeps cells that are close on the board close in
+// the solver's per-variable arrays; codes are ranked so numbering stays dense
+// on boards that are not a power of two wide, or have holes.
+void Solver::init_layout() {
+	cell_order.assign(rows * cols, -1);
+	num_cells = 0;
+	if (options.layout != VarLayout::morton) {
+		for (int r = 0; r < rows; r++) {
+			for (int c = 0; c < cols; c++) {
+				if (is_valid_space(r, c)) {
+					cell_order[r * cols + c] = num_cells++;
+				}
+			}
+		}
+		return;
+	}
+	vector<pair<uint64_t, int>> codes;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				continue;
+			}
+			uint64_t code = 0;
+			for (int bit = 0; bit < 32; bit++) {
+				code |= (uint64_t)((c >> bit) & 1) << (2 * bit);
+				code |= (uint64_t)((r >> bit) & 1) << (2 * bit + 1);
+			}
+			codes.push_back(pair<uint64_t, int>(code, r * cols + c));
+		}
+	}
+	std::sort(codes.begin(), codes.end());
+	for (auto& code : codes) {
+		cell_order[code.second] = num_cells++;
+	}
+}
+
+Minisat::Lit Solver::color_lit(int r, int c, int color) {
+	if (options.encoding == ColorEncoding::one_hot) {
+		return Minisat::mkLit(to_var(r, c, color));
+	}
+	// Channel to a one-hot literal, created the first time it is needed
+	auto channel = channels.emplace(cell_order[r * cols + c] * (int64_t)num_colors + color, Minisat::lit_Undef);
+	Minisat::Lit& res = channel.first->second;
+	if (channel.second) {
+		res = makeVar(VarClass::aux);
+		Minisat::vec<Minisat::Lit> v;
+		v.push(res);
+		for (int i = 0; i < color_bits; i++) {
+			Minisat::Lit bit = Minisat::mkLit(bit_var(r, c, i), !((color >> i) & 1));
+			backend->add_clause(~res, bit);
+			v.push(~bit);
+		}
+		backend->add_clause(v);
+	}
+	return res;
+}
+
+Minisat::Lit Solver::edge_lit(pair<int, int> a, pair<int, int> b) {
+	if (b < a) {
+		std::swap(a, b);
+	}
+	return edges[cell_order[a.first * cols + a.second] * 2 + (b.first == a.first)];
 }
 
 board Solver::get_solution() {
 	board res = board();
-	for (int r = 0; r < n; r++) {
+	for (int r = 0; r < rows; r++) {
 		vector<int> row;
-		for (int c = 0; c < n; c++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				row.push_back(hole);
+				continue;
+			}
+			if (options.encoding == ColorEncoding::log) {
+				int color = 0;
+				for (int i = 0; i < color_bits; i++) {
+					color |= backend->model_value(bit_var(r, c, i)).isTrue() << i;
+				}
+				row.push_back(color);
+				continue;
+			}
 			int found = 0;
 			for (int color = 0; color < num_colors; color++) {
-				if (solver.modelValue(to_var(r, c, color)).isTrue()) {
+				if (backend->model_value(to_var(r, c, color)).isTrue()) {
 					found++;
 					row.push_back(color);
 				}
@@ -116,9 +640,16 @@ board Solver::get_solution() {
 }
 
 
-void Solver::create_expression(unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> endpoints) {
-	for (int r = 0; r < n; r++) {
-		for (int c = 0; c < n; c++) {
+void Solver::create_expression(endpoint_map endpoints) {
+	if (options.encoding == ColorEncoding::log) {
+		create_log_expression(endpoints);
+		return;
+	}
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				continue;
+			}
 			pair<int, int> cur_point(r, c);
 			auto color = endpoints.find(cur_point);
 			if (color != endpoints.end()) {
@@ -128,36 +659,294 @@ void Solver::create_expression(unordered_map<pair<int, int>, int, boost::hash<pa
 			else {
 				at_most_one_color(r, c);
 				at_least_one_working_neighbors(r, c);
+				if (options.shortcut_clauses) {
+					no_shortcuts(r, c);
+				}
+			}
+			if (options.block_clauses) {
+				no_same_color_block(r, c);
 			}
 		}
 	}
 }
 
+// Colors as ceil(log2(num_colors)) bits per cell. Neighbors of equal color
+// are tracked by one variable per edge, which is all the degree constraints
+// need; one-hot literals are only channeled where other constraints ask for
+// them (see color_lit).
+void Solver::create_log_expression(endpoint_map endpoints) {
+	edges.assign(num_cells * 2, Minisat::lit_Undef);
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				continue;
+			}
+			// value <= num_colors - 1: a bit that is 0 in the bound can only
+			// be set if a higher bit that is 1 in the bound is not
+			int bound = num_colors - 1;
+			for (int i = 0; i < color_bits; i++) {
+				if ((bound >> i) & 1) {
+					continue;
+				}
+				Minisat::vec<Minisat::Lit> v;
+				v.push(~Minisat::mkLit(bit_var(r, c, i)));
+				for (int j = i + 1; j < color_bits; j++) {
+					if ((bound >> j) & 1) {
+						v.push(~Minisat::mkLit(bit_var(r, c, j)));
+					}
+				}
+				backend->add_clause(v);
+			}
+			auto endpoint = endpoints.find(pair<int, int>(r, c));
+			if (endpoint != endpoints.end()) {
+				for (int i = 0; i < color_bits; i++) {
+					backend->add_clause(Minisat::mkLit(bit_var(r, c, i), !((endpoint->second >> i) & 1)));
+				}
+			}
+			const pair<int, int> forward[] = { {r + 1, c}, {r, c + 1} };
+			for (auto& other : forward) {
+				if (is_valid_space(other.first, other.second)) {
+					edges[cell_order[r * cols + c] * 2 + (other.first == r)] = equal_colors(r, c, other.first, other.second);
+				}
+			}
+		}
+	}
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				continue;
+			}
+			vector<Minisat::Lit> incident;
+			for (auto& neighbor : get_neighbors(r, c)) {
+				incident.push_back(edge_lit(pair<int, int>(r, c), neighbor));
+			}
+			int need = endpoints.count(pair<int, int>(r, c)) ? 1 : 2;
+			for (auto& combo : combination(incident.size(), need + 1)) {
+				Minisat::vec<Minisat::Lit> v;
+				for (int index : combo) {
+					v.push(~incident[index]);
+				}
+				backend->add_clause(v);
+			}
+			if (incident.size() < need) {
+				backend->add_empty_clause();
+			}
+			for (auto& combo : combination(incident.size(), incident.size() - need + 1)) {
+				Minisat::vec<Minisat::Lit> v;
+				for (int index : combo) {
+					v.push(incident[index]);
+				}
+				backend->add_clause(v);
+			}
+			if (need == 2 && options.shortcut_clauses) {
+				no_shortcuts(r, c);
+			}
+			if (options.block_clauses) {
+				no_same_color_block(r, c);
+			}
+		}
+	}
+}
+
+// A literal that is true iff the two cells have the same color
+Minisat::Lit Solver::equal_colors(int r1, int c1, int r2, int c2) {
+	Minisat::Lit eq = makeVar(VarClass::aux);
+	Minisat::vec<Minisat::Lit> differs;
+	differs.push(eq);
+	for (int i = 0; i < color_bits; i++) {
+		Minisat::Lit a = Minisat::mkLit(bit_var(r1, c1, i));
+		Minisat::Lit b = Minisat::mkLit(bit_var(r2, c2, i));
+		backend->add_clause(~eq, ~a, b);
+		backend->add_clause(~eq, a, ~b);
+		Minisat::Lit d = makeVar(VarClass::aux);
+		backend->add_clause(~d, a, b);
+		backend->add_clause(~d, ~a, ~b);
+		backend->add_clause(d, ~a, b);
+		backend->add_clause(d, a, ~b);
+		differs.push(d);
+	}
+	backend->add_clause(differs);
+	return eq;
+}
+
+void Solver::acyclicity(endpoint_map endpoints) {
+	if (options.acyclic == Acyclicity::none) {
+		return;
+	}
+	// One endpoint per color is the source of its path
+	vector<pair<int, int>> sources(num_colors, pair<int, int>(rows, cols));
+	for (auto& endpoint : endpoints) {
+		sources[endpoint.second] = std::min(sources[endpoint.second], endpoint.first);
+	}
+	vector<vector<vector<Minisat::Lit>>> ranks(rows, vector<vector<Minisat::Lit>>(cols));
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (is_valid_space(r, c)) {
+				ranks[r][c] = make_rank();
+			}
+		}
+	}
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (!is_valid_space(r, c)) {
+				continue;
+			}
+			auto source = endpoints.find(pair<int, int>(r, c));
+			if (source != endpoints.end() && sources[source->second] == source->first) {
+				continue;
+			}
+			// Some same-colored neighbor comes before this cell
+			Minisat::vec<Minisat::Lit> preds;
+			for (auto& neighbor : get_neighbors(r, c)) {
+				Minisat::Lit p = makeVar(VarClass::order);
+				preds.push(p);
+				if (options.encoding == ColorEncoding::log) {
+					backend->add_clause(~p, edge_lit(pair<int, int>(r, c), neighbor));
+				}
+				for (int color = 0; color < num_colors && options.encoding == ColorEncoding::one_hot; color++) {
+					backend->add_clause(~p, ~color_lit(r, c, color), color_lit(neighbor.first, neighbor.second, color));
+				}
+				rank_less(p, ranks[neighbor.first][neighbor.second], ranks[r][c]);
+			}
+			backend->add_clause(preds);
+		}
+	}
+}
+
+vector<Minisat::Lit> Solver::make_rank() {
+	vector<Minisat::Lit> res;
+	if (options.acyclic == Acyclicity::unary) {
+		// res[i] is true iff the rank is greater than i
+		for (int i = 0; i < num_cells - 1; i++) {
+			res.push_back(makeVar(VarClass::order));
+			if (i > 0) {
+				backend->add_clause(~res[i], res[i - 1]);
+			}
+		}
+	}
+	else {
+		for (int range = 1; range < num_cells || res.empty(); range *= 2) {
+			res.push_back(makeVar(VarClass::order));
+		}
+	}
+	return res;
+}
+
+// p implies a < b
+void Solver::rank_less(Minisat::Lit p, const vector<Minisat::Lit>& a, const vector<Minisat::Lit>& b) {
+	if (options.acyclic == Acyclicity::unary) {
+		int len = a.size();
+		if (len == 0) {
+			backend->add_clause(~p);
+			return;
+		}
+		backend->add_clause(~p, b[0]);
+		for (int i = 0; i + 1 < len; i++) {
+			backend->add_clause(~p, ~a[i], b[i + 1]);
+		}
+		backend->add_clause(~p, ~a[len - 1]);
+		return;
+	}
+	// Binary comparison from the least significant bit up
+	shared_ptr<BoolExpr> less = combine(neg(lit(a[0])), lit(b[0]), "&");
+	for (int i = 1; i < a.size(); i++) {
+		shared_ptr<BoolExpr> equal = combine(combine(lit(a[i]), lit(b[i]), "&"), combine(neg(lit(a[i])), neg(lit(b[i])), "&"), "|");
+		less = combine(combine(neg(lit(a[i])), lit(b[i]), "&"), combine(equal, less, "&"), "|");
+	}
+	tseitin(combine(neg(lit(p)), less, "|"));
+}
+
+void Solver::no_same_color_block(int r, int c) {
+	if (!is_valid_space(r + 1, c) || !is_valid_space(r, c + 1) || !is_valid_space(r + 1, c + 1)) {
+		return;
+	}
+	if (options.encoding == ColorEncoding::log) {
+		backend->add_clause(~edge_lit(pair<int, int>(r, c), pair<int, int>(r + 1, c)), ~edge_lit(pair<int, int>(r, c), pair<int, int>(r, c + 1)),
+			~edge_lit(pair<int, int>(r + 1, c), pair<int, int>(r + 1, c + 1)));
+		return;
+	}
+	for (int color = 0; color < num_colors; color++) {
+		Minisat::vec<Minisat::Lit> v;
+		v.push(~color_lit(r, c, color));
+		v.push(~color_lit(r + 1, c, color));
+		v.push(~color_lit(r, c + 1, color));
+		v.push(~color_lit(r + 1, c + 1, color));
+		backend->add_clause(v);
+	}
+}
+
+// A path never wraps around three sides of an empty cell: the cell could
+// not take that color (three neighbors of its own color) nor any other (one
+// neighbor left). Implied by the degree constraints, but only after trying
+// every color of the cell; these clauses propagate it directly. The log
+// encoding has no literal for two cells around a corner having the same
+// color, so there it forbids the tightest wrap: through the two corners on
+// the side away from the open one, four edges of one color.
+void Solver::no_shortcuts(int r, int c) {
+	if (options.encoding == ColorEncoding::log) {
+		const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+		for (auto& open : dirs) {
+			pair<int, int> far(r - open[0], c - open[1]);
+			pair<int, int> side1(r + open[1], c + open[0]);
+			pair<int, int> side2(r - open[1], c - open[0]);
+			pair<int, int> corner1(side1.first - open[0], side1.second - open[1]);
+			pair<int, int> corner2(side2.first - open[0], side2.second - open[1]);
+			if (!is_valid_space(far.first, far.second) || !is_valid_space(side1.first, side1.second) || !is_valid_space(side2.first, side2.second)
+				|| !is_valid_space(corner1.first, corner1.second) || !is_valid_space(corner2.first, corner2.second)) {
+				continue;
+			}
+			Minisat::vec<Minisat::Lit> v;
+			v.push(~edge_lit(side1, corner1));
+			v.push(~edge_lit(corner1, far));
+			v.push(~edge_lit(far, corner2));
+			v.push(~edge_lit(corner2, side2));
+			backend->add_clause(v);
+		}
+		return;
+	}
+	vector<pair<int, int>> neighbors = get_neighbors(r, c);
+	vector<vector<int>> choose3 = combination(neighbors.size(), 3);
+	for (int color = 0; color < num_colors; color++) {
+		for (auto& combo : choose3) {
+			Minisat::vec<Minisat::Lit> v;
+			for (int index : combo) {
+				v.push(~color_lit(neighbors[index].first, neighbors[index].second, color));
+			}
+			backend->add_clause(v);
+		}
+	}
+}
+
 void Solver::at_most_one_color(int r, int c) {
 	for (int i = 0; i < num_colors; i++) {
 		for (int j = i + 1; j < num_colors; j++) {
-			solver.addClause(~Minisat::mkLit(to_var(r, c, i)), ~Minisat::mkLit(to_var(r, c, j)));
+			backend->add_clause(~color_lit(r, c, i), ~color_lit(r, c, j));
 		}
 	}
 }
 
 void Solver::exact_num_neighbors(int r, int c, int color) {
-	solver.addClause(Minisat::mkLit(to_var(r, c, color)));
+	backend->add_clause(color_lit(r, c, color));
 	vector<pair<int, int>> neighbors = get_neighbors(r, c);
 	Minisat::vec<Minisat::Lit> v;
 	for (auto& neighbor : neighbors) {
-		v.push(Minisat::mkLit(to_var(neighbor.first, neighbor.second, color)));
+		v.push(color_lit(neighbor.first, neighbor.second, color));
 	}
-	solver.addClause(v);
+	backend->add_clause(v);
 	for (auto& combo : combination(neighbors.size(), 2)) {
 		pair<int, int> neighbor1 = neighbors[combo[0]];
 		pair<int, int> neighbor2 = neighbors[combo[1]];
-		solver.addClause(~Minisat::mkLit(to_var(neighbor1.first, neighbor1.second, color)), ~Minisat::mkLit(to_var(neighbor2.first, neighbor2.second, color)));
+		backend->add_clause(~color_lit(neighbor1.first, neighbor1.second, color), ~color_lit(neighbor2.first, neighbor2.second, color));
 	}
 }
 
 void Solver::at_least_one_working_neighbors(int r, int c) {
 	vector<pair<int, int>> neighbors = get_neighbors(r, c);
+	// A dead end: no color can pass through
+	if (neighbors.size() < 2) {
+		backend->add_empty_clause();
+		return;
+	}
 	vector<vector<int>> choose3 = combination(neighbors.size(), 3);
 	vector<vector<int>> choose2 = combination(neighbors.size(), 2);
 
@@ -211,7 +1000,7 @@ vector<pair<int, int>> Solver::get_neighbors(int r, int c) {
 }
 
 bool Solver::is_valid_space(int r, int c) {
-	return !(r < 0 || c < 0 || r >= n || c >= n);
+	return !(r < 0 || c < 0 || r >= rows || c >= cols) && (region.live.empty() || region.live[r][c]);
 }
 
 vector<vector<int>> combination(int n, int k) {
@@ -1,45 +1,271 @@
 #pragma once
 
-#include <minisat/core/Solver.h>
-#include <boost/functional/hash.hpp>
-#include "BoolExpr.hpp"
+#include "Board.hpp"
+#include "SatBackend.hpp"
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include <utility>
 
-using std::shared_ptr;
-using std::vector;
-using std::unordered_map;
-using std::pair;
+struct BoolExpr;
+struct PreprocessResult;
 
-using board = vector<vector<int>>;
-using char_board = vector<vector<char>>;
+// Order in which the decision heuristic first visits the cell variables.
+// Anything other than vsids only seeds the initial activities; conflicts
+// take over from there.
+enum class DecisionOrder {
+	vsids,
+	color_major,
+	endpoint_distance
+};
 
-class Solver {
+// Kinds of variables created by the encoder. Each kind has its own
+// decision policy in SolverOptions.
+enum class VarClass {
+	cell,
+	aux,
+	order
+};
+
+// How the encoding rules out same-color cycles that are not connected to
+// the color's endpoints. Every cell but one endpoint per color needs a
+// same-colored neighbor of lower rank, with ranks kept in unary (order
+// encoding) or binary bits.
+enum class Acyclicity {
+	none,
+	unary,
+	binary
+};
+
+// Which redundant constraints find_cut_constraints() adds.
+enum class CutLevel {
+	none,
+	units,
+	pairs
+};
+
+// How a cell's color is stored: one variable per color, or the color index
+// in binary (see create_log_expression). automatic uses one-hot for boards
+// with up to 26 colors whose estimated size fits the encoder budget, and log
+// otherwise.
+enum class ColorEncoding {
+	automatic,
+	one_hot,
+	log
+};
+
+// Numbering of the cell variables. color_major puts all cells of one color
+// next to each other; cell_major and morton keep the variables of a cell,
+// and of nearby cells, together.
+enum class VarLayout {
+	color_major,
+	cell_major,
+	morton
+};
+
+// Periodic search statistics while solving, as text or as one JSON object
+// per line, passed to SolverOptions::progress_output.
+enum class ProgressFormat {
+	none,
+	text,
+	json
+};
+
+// What solves the board: Minisat on the CNF encoding, Minisat's SimpSolver,
+// which first eliminates variables of the encoding, or NativeSolver, a
+// depth-first search over the paths themselves that needs no encoding.
+enum class Backend {
+	minisat,
+	simp,
+	native
+};
+
+enum class SolveResult {
+	solved,
+	unsolvable,
+	indeterminate,  // A budget ran out or the search was interrupted
+	out_of_memory   // The search needed more than memory_limit_mb
+};
+
+struct SolverOptions {
+	Backend backend = Backend::minisat;
+	// Tseitin auxiliaries are fully defined by the cell variables, so
+	// branching on them only wastes decisions.
+	bool decide_cells = true;
+	bool decide_aux = false;
+	// Ranks are not determined by the cells, so they must stay decisions
+	bool decide_order = true;
+	DecisionOrder order = DecisionOrder::vsids;
+	ColorEncoding encoding = ColorEncoding::automatic;
+	// Boards whose estimated instance is larger than this are rejected
+	// before anything is built (see estimate_size).
+	int encoder_budget_mb = 2048;
+	VarLayout layout = VarLayout::color_major;
+	// Add the forced moves found by preprocess() before solving.
+	bool preprocess = true;
+	CutLevel cuts = CutLevel::none;
+	// Redundant clauses: no color fills a 2x2 block, and no path wraps around
+	// three sides of an empty cell, stated directly on the cell variables
+	// instead of through the Tseitin encoding. Under the log encoding the
+	// shortcut clauses only forbid paths that wrap tightly around the cell.
+	bool block_clauses = false;
+	bool shortcut_clauses = false;
+	Acyclicity acyclic = Acyclicity::none;
+	// Used by solve_board(): split the board into independent regions and
+	// solve them concurrently.
+	bool decompose = false;
+	// Search limits, -1 for none. Budgets count from the start of solve().
+	int64_t conflict_budget = -1;
+	int64_t propagation_budget = -1;
+	// Wall-clock limit in seconds for solve_board(), 0 for none. Enforced by
+	// a Watchdog that interrupts the search.
+	double timeout = 0;
+	// Memory ceiling for each SAT solver in megabytes, 0 for none. Learnt
+	// clauses are dropped to stay under it before the search gives up.
+	int memory_limit_mb = 0;
+	ProgressFormat progress = ProgressFormat::none;
+	double progress_interval = 1;  // Seconds between progress lines
+	// Receives each progress line, newline included. Nothing is reported
+	// without one; the solver never writes to stdout or stderr itself.
+	std::function<void(const std::string&)> progress_output;
+};
+
+// Cells of the rows x cols grid that are part of the board: the holes of an
+// irregular board, or the part solved on its own by decompose(). Cells
+// outside the region get no variables and no constraints. banned lists the
+// colors a cell cannot take because of fixed cells next to it that are not
+// part of the region. An empty region is the whole grid.
+struct Region {
+	std::vector<std::vector<bool>> live;
+	std::vector<std::vector<std::vector<int>>> banned;
+};
+
+// Upper estimate of the CNF for a board, computed from its dimensions alone.
+// Clauses that preprocessing satisfies are counted as well.
+struct InstanceSize {
+	uint64_t vars = 0;
+	uint64_t clauses = 0;
+	uint64_t literals = 0;
+	// Memory the SAT solver needs to hold the instance
+	uint64_t bytes() const;
+};
+
+// cells and edges count the cells of the region and the adjacent pairs among
+// them; options.encoding must not be automatic.
+InstanceSize estimate_size(uint64_t cells, uint64_t edges, uint64_t endpoints, const SolverOptions& options);
+
+struct SolverStats {
+	int vars;
+	int decision_vars;
+	int clauses;
+	uint64_t literals;
+	uint64_t decisions;
+	uint64_t conflicts;
+	uint64_t propagations;
+	int fixed_cells;  // Non-endpoint cells resolved by preprocessing
+	int free_cells;   // Non-endpoint cells on the board
+};
+
+// Something a Watchdog can stop: a solver whose search can be interrupted
+// from another thread.
+class Interruptible {
+public:
+	virtual ~Interruptible() {}
+	virtual void interrupt() = 0;
+	// Lets the next solve run again; an interrupt stays in effect until then
+	virtual void clear_interrupt() = 0;
+};
+
+// Encodes a board as CNF and solves it with a SatBackend (options.backend
+// minisat or simp).
+class Solver : public Interruptible {
 private:
-	Minisat::Solver solver;
+	std::unique_ptr<SatBackend> backend;
+	SolverOptions options;
+	Region region;
 	int num_vars = 0;
+	int num_decision_vars = 0;
+	int fixed_cells = 0;
+	int free_cells = 0;
 	int num_colors;
-	int n;
+	int rows;
+	int cols;
+	int num_cells = 0;  // Cells in the region
+	int color_bits = 0;
+	std::vector<int> cell_order;
+	std::unordered_map<int64_t, Minisat::Lit> channels;  // Only the channels in use, see color_lit
+	std::vector<Minisat::Lit> edges;
+	bool cells_frozen = false;
+	std::vector<std::pair<int, int>> conflicts;
+	std::chrono::steady_clock::time_point solve_start;
+	std::chrono::steady_clock::time_point last_report;
+	uint64_t last_conflicts = 0;
 
 public:
 	Solver();
-	Solver(int n, unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> endpoints);
-	bool solve();
+	Solver(const board& b, SolverOptions options = SolverOptions());
+	Solver(int rows, int cols, endpoint_map endpoints, SolverOptions options = SolverOptions(), Region region = Region());
+	SolveResult solve();
+	// Solves with the colored cells of hints (-1 for none, the size of the
+	// board) assumed rather than added, so the same Solver can be solved again
+	// with other hints. With the simp backend the cell variables are kept out
+	// of elimination from the first solve(hints) on; solve once with empty
+	// hints first if later solves will have some.
+	SolveResult solve(const board& hints);
+	// The same, with cell (r, c) taking any color but color: unsolvable
+	// means the hints force color there.
+	SolveResult solve_excluding(const board& hints, int r, int c, int color);
+	// After solve(hints) found the board unsolvable: hinted cells that
+	// together cannot be part of a solution. Empty if the board has no
+	// solution whatever the hints.
+	std::vector<std::pair<int, int>> conflicting_hints();
+	// Replaces the search limits of options for the next solves
+	void set_budget(int64_t conflicts, int64_t propagations);
+	// Stops a running solve() with an indeterminate result. Safe to call from
+	// any thread. Later solves stop at once too, until clear_interrupt().
+	void interrupt() override;
+	void clear_interrupt() override;
 	board get_solution();
-	void tseitin(shared_ptr<BoolExpr> b);
-	Minisat::Lit makeVar();
+	SolverStats stats();
+	void tseitin(std::shared_ptr<BoolExpr> b);
+	Minisat::Lit makeVar(VarClass kind = VarClass::aux);
 
 private:
+	static Region board_region(const board& b);
+	SolveResult solve_hinted(const board& hints, Minisat::Lit extra);
+	void freeze_cells();
+	SolveResult solve_assuming(const Minisat::vec<Minisat::Lit>& assumptions);
+	void report_progress();
+	int count_fixed_cells();
+	void choose_encoding(uint64_t endpoints);
 	void init_vars();
+	void init_layout();
 	Minisat::Var to_var(int r, int c, int color);
-	void tseitin_helper(shared_ptr<BoolExpr> b, Minisat::Lit cur);
-	void create_expression(unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> endpoints);
+	Minisat::Var bit_var(int r, int c, int i);
+	Minisat::Lit color_lit(int r, int c, int color);
+	Minisat::Lit edge_lit(std::pair<int, int> a, std::pair<int, int> b);
+	bool is_decision(VarClass kind);
+	void seed_decision_order(endpoint_map endpoints);
+	void add_deductions(const PreprocessResult& pre);
+	void restrict_to_region();
+	void add_cut_constraints(const board& known, endpoint_map endpoints);
+	void tseitin_helper(std::shared_ptr<BoolExpr> b, Minisat::Lit cur);
+	void create_expression(endpoint_map endpoints);
+	void create_log_expression(endpoint_map endpoints);
+	Minisat::Lit equal_colors(int r1, int c1, int r2, int c2);
 	void at_most_one_color(int r, int c);
 	void exact_num_neighbors(int r, int c, int color);
 	void at_least_one_working_neighbors(int r, int c);
-	vector<pair<int, int>> get_neighbors(int r, int c);
+	void no_same_color_block(int r, int c);
+	void no_shortcuts(int r, int c);
+	void acyclicity(endpoint_map endpoints);
+	std::vector<Minisat::Lit> make_rank();
+	void rank_less(Minisat::Lit p, const std::vector<Minisat::Lit>& a, const std::vector<Minisat::Lit>& b);
+	std::vector<std::pair<int, int>> get_neighbors(int r, int c);
 	bool is_valid_space(int r, int c);
 };
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "Symmetry.hpp"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace {
+
+// Visits the cells of a rows x cols board, stored row by row, in the order of
+// the transformed board: cell (r, c) of the result is base + r * dr + c * dc.
+struct Walk {
+	int rows;
+	int cols;
+	int base;
+	int dr;
+	int dc;
+};
+
+Walk make_walk(int rows, int cols, int symmetry) {
+	bool flip_rows = symmetry & 1;
+	bool flip_cols = symmetry & 2;
+	bool transpose = symmetry & 4;
+	Walk w;
+	w.base = (flip_rows ? rows - 1 : 0) * cols + (flip_cols ? cols - 1 : 0);
+	int row_step = flip_rows ? -cols : cols;
+	int col_step = flip_cols ? -1 : 1;
+	w.rows = transpose ? cols : rows;
+	w.cols = transpose ? rows : cols;
+	w.dr = transpose ? col_step : row_step;
+	w.dc = transpose ? row_step : col_step;
+	return w;
+}
+
+vector<int> flatten(const board& b, int& max_color) {
+	vector<int> cells;
+	for (auto& row : b) {
+		for (int value : row) {
+			cells.push_back(value);
+			max_color = std::max(max_color, value);
+		}
+	}
+	return cells;
+}
+
+}
+
+board canonicalize(const board& b, BoardTransform& transform) {
+	int rows = b.size();
+	int cols = rows ? b[0].size() : 0;
+	int max_color = -1;
+	vector<int> cells = flatten(b, max_color);
+
+	// Candidates are built cell by cell and dropped at the first cell that
+	// makes them larger than the best one so far
+	vector<int> best;
+	vector<int> best_colors;
+	Walk best_walk = make_walk(rows, cols, 0);
+	vector<int> cur(cells.size());
+	vector<int> colors;
+	for (int symmetry = 0; symmetry < 8; symmetry++) {
+		Walk w = make_walk(rows, cols, symmetry);
+		if (symmetry > 0 && w.rows > best_walk.rows) {
+			continue;
+		}
+		int order = symmetry == 0 || w.rows < best_walk.rows ? -1 : 0;
+		colors.assign(max_color + 1, -1);
+		int next_color = 0;
+		int i = 0;
+		for (int r = 0; r < w.rows && order <= 0; r++) {
+			int src = w.base + r * w.dr;
+			for (int c = 0; c < w.cols; c++, i++, src += w.dc) {
+				int value = cells[src];
+				if (value >= 0) {
+					if (colors[value] < 0) {
+						colors[value] = next_color++;
+					}
+					value = colors[value];
+				}
+				if (order == 0 && value != best[i]) {
+					order = value < best[i] ? -1 : 1;
+					if (order > 0) {
+						break;
+					}
+				}
+				cur[i] = value;
+			}
+		}
+		if (order < 0) {
+			best.swap(cur);
+			best_colors.swap(colors);
+			best_walk = w;
+			transform.symmetry = symmetry;
+			cur.resize(cells.size());
+		}
+	}
+	transform.colors = best_colors;
+
+	board res(best_walk.rows, vector<int>(best_walk.cols));
+	for (int r = 0, i = 0; r < best_walk.rows; r++) {
+		for (int c = 0; c < best_walk.cols; c++, i++) {
+			res[r][c] = best[i];
+		}
+	}
+	return res;
+}
+
+board apply_transform(const board& b, const BoardTransform& transform) {
+	int rows = b.size();
+	int cols = rows ? b[0].size() : 0;
+	int max_color = -1;
+	vector<int> cells = flatten(b, max_color);
+	Walk w = make_walk(rows, cols, transform.symmetry);
+	board res(w.rows, vector<int>(w.cols));
+	for (int r = 0; r < w.rows; r++) {
+		int src = w.base + r * w.dr;
+		for (int c = 0; c < w.cols; c++, src += w.dc) {
+			int value = cells[src];
+			res[r][c] = value >= 0 ? transform.colors[value] : value;
+		}
+	}
+	return res;
+}
+
+board undo_transform(const board& canonical, const BoardTransform& transform) {
+	int rows = canonical.size();
+	int cols = rows ? canonical[0].size() : 0;
+	if (transform.symmetry & 4) {
+		std::swap(rows, cols);
+	}
+	vector<int> original_color;
+	for (int color = 0; color < transform.colors.size(); color++) {
+		int to = transform.colors[color];
+		if (to >= 0) {
+			if (to >= original_color.size()) {
+				original_color.resize(to + 1, -1);
+			}
+			original_color[to] = color;
+		}
+	}
+	Walk w = make_walk(rows, cols, transform.symmetry);
+	vector<int> cells(rows * cols);
+	for (int r = 0; r < w.rows; r++) {
+		int dst = w.base + r * w.dr;
+		for (int c = 0; c < w.cols; c++, dst += w.dc) {
+			int value = canonical[r][c];
+			cells[dst] = value >= 0 ? original_color[value] : value;
+		}
+	}
+	board res(rows, vector<int>(cols));
+	for (int r = 0, i = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++, i++) {
+			res[r][c] = cells[i];
+		}
+	}
+	return res;
+}
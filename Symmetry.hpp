@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Board.hpp"
+
+#include <vector>
+
+// How a board maps onto its canonical form: one of the eight symmetries of
+// the rectangle, then colors renamed in order of first appearance. Bit 0 of
+// symmetry flips the rows, bit 1 the columns, and bit 2 transposes the
+// flipped board.
+struct BoardTransform {
+	int symmetry = 0;
+	std::vector<int> colors;   // Original color -> canonical color
+};
+
+// The smallest of the eight rotated and reflected copies of b, after
+// renaming colors by first appearance (row by row). Boards that differ only
+// in orientation or color names get the same canonical form. Holes and empty
+// cells are kept as they are.
+board canonicalize(const board& b, BoardTransform& transform);
+
+// Applies transform to another board over the same grid and colors, such as
+// the solution of the board it came from.
+board apply_transform(const board& b, const BoardTransform& transform);
+
+// The inverse of apply_transform(): maps a board in canonical form, such as
+// the solution of a canonical board, back onto the original grid and colors.
+board undo_transform(const board& canonical, const BoardTransform& transform);
@@ -0,0 +1,187 @@
+#include "Validate.hpp"
+#include "Cuts.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+using std::vector;
+
+using cell = std::pair<int, int>;
+
+namespace {
+
+const int dirs[4][2] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+std::string color_name(int color, int num_colors) {
+	return num_colors <= 26 ? std::string(1, 'a' + color) : std::to_string(color);
+}
+
+std::string at(int r, int c) {
+	return "row " + std::to_string(r + 1) + " column " + std::to_string(c + 1);
+}
+
+}
+
+void validate_endpoints(const endpoint_map& endpoints) {
+	int num_colors = 0;
+	for (auto& endpoint : endpoints) {
+		num_colors = std::max(num_colors, endpoint.second + 1);
+	}
+	vector<vector<cell>> ends(num_colors);
+	for (auto& endpoint : endpoints) {
+		ends[endpoint.second].push_back(endpoint.first);
+	}
+	for (int color = 0; color < num_colors; color++) {
+		if (ends[color].size() == 2) {
+			continue;
+		}
+		std::string msg = "Error: color " + color_name(color, num_colors) + " has " + std::to_string(ends[color].size()) + (ends[color].size() == 1 ? " endpoint" : " endpoints");
+		std::sort(ends[color].begin(), ends[color].end());
+		for (size_t i = 0; i < ends[color].size(); i++) {
+			msg += (i ? ", " : " (") + at(ends[color][i].first, ends[color][i].second);
+		}
+		throw std::runtime_error(ends[color].empty() ? msg : msg + ")");
+	}
+}
+
+void validate_board(const board& b) {
+	for (int r = 0; r < b.size(); r++) {
+		if (b[r].size() != b[0].size()) {
+			throw std::runtime_error("Error: row " + std::to_string(r + 1) + " has " + std::to_string(b[r].size()) + " cells, row 1 has " + std::to_string(b[0].size()));
+		}
+		for (int c = 0; c < b[r].size(); c++) {
+			if (b[r][c] < hole) {
+				throw std::runtime_error("Error: invalid cell value " + std::to_string(b[r][c]) + " at " + at(r, c));
+			}
+		}
+	}
+	validate_endpoints(endpoints_from_board(b));
+}
+
+std::string unsolvable_reason(const board& b) {
+	int h = b.size();
+	int w = h ? b[0].size() : 0;
+	int num_colors = 0;
+	vector<vector<int>> ends;
+	int live = 0;
+	for (int r = 0; r < h; r++) {
+		for (int c = 0; c < w; c++) {
+			if (b[r][c] >= 0) {
+				num_colors = std::max(num_colors, b[r][c] + 1);
+				ends.resize(num_colors);
+				ends[b[r][c]].push_back(r * w + c);
+			}
+			live += b[r][c] != hole;
+		}
+	}
+	auto neighbors = [&](int v, vector<int>& res) {
+		res.clear();
+		for (auto& dir : dirs) {
+			int r = v / w + dir[0];
+			int c = v % w + dir[1];
+			if (r >= 0 && c >= 0 && r < h && c < w && b[r][c] != hole) {
+				res.push_back(r * w + c);
+			}
+		}
+	};
+
+	// A path cell needs two neighbors, an endpoint one
+	vector<int> adj;
+	for (int v = 0; v < h * w; v++) {
+		int value = b[v / w][v % w];
+		if (value == hole) {
+			continue;
+		}
+		neighbors(v, adj);
+		if (value < 0 && adj.size() < 2) {
+			return "empty cell at " + at(v / w, v % w) + " is a dead end";
+		}
+		if (value >= 0 && adj.empty()) {
+			return "endpoint at " + at(v / w, v % w) + " is walled in";
+		}
+	}
+
+	// Connected areas of empty cells. A path only runs through empty cells,
+	// so its endpoints are next to each other or to the same area, and every
+	// area needs a color with both endpoints next to it.
+	vector<int> comp(h * w, -1);
+	int num_comps = 0;
+	vector<int> stack;
+	for (int v = 0; v < h * w; v++) {
+		if (b[v / w][v % w] != -1 || comp[v] >= 0) {
+			continue;
+		}
+		comp[v] = num_comps;
+		stack.push_back(v);
+		while (!stack.empty()) {
+			int cur = stack.back();
+			stack.pop_back();
+			neighbors(cur, adj);
+			for (int u : adj) {
+				if (b[u / w][u % w] == -1 && comp[u] < 0) {
+					comp[u] = num_comps;
+					stack.push_back(u);
+				}
+			}
+		}
+		num_comps++;
+	}
+	vector<bool> reached(num_comps, false);
+	vector<int> touched(num_comps, -1);  // Last color seen next to each area
+	for (int color = 0; color < num_colors; color++) {
+		int a = ends[color][0];
+		int z = ends[color][1];
+		bool connected = false;
+		neighbors(a, adj);
+		for (int u : adj) {
+			connected |= u == z;
+			if (comp[u] >= 0) {
+				touched[comp[u]] = color;
+			}
+		}
+		neighbors(z, adj);
+		for (int u : adj) {
+			if (comp[u] >= 0 && touched[comp[u]] == color) {
+				reached[comp[u]] = true;
+				connected = true;
+			}
+		}
+		if (!connected) {
+			return "endpoints of color " + color_name(color, num_colors) + " at " + at(a / w, a % w) + " and " + at(z / w, z % w) + " cannot be connected";
+		}
+	}
+	for (int v = 0; v < h * w; v++) {
+		if (comp[v] >= 0 && !reached[comp[v]]) {
+			return "empty cells around " + at(v / w, v % w) + " cannot be reached by any color";
+		}
+	}
+
+	// On a checkerboard a path alternates square colors, so it has an odd
+	// number of cells exactly when its endpoints are on squares of the same
+	// color. The paths together cover every cell.
+	int odd_paths = 0;
+	for (int color = 0; color < num_colors; color++) {
+		int a = ends[color][0];
+		int z = ends[color][1];
+		odd_paths += (a / w + a % w) % 2 == (z / w + z % w) % 2;
+	}
+	if ((live - odd_paths) % 2 != 0) {
+		return std::string("checkerboard parity: the paths would cover an ") + (odd_paths % 2 ? "odd" : "even") + " number of cells, the board has " + std::to_string(live);
+	}
+
+	// Cells that separate two colors' endpoints would have to take both colors
+	CutConstraints cuts = find_cut_constraints(b, endpoints_from_board(b), false);
+	if (cuts.contradiction) {
+		return "some color cannot connect its endpoints";
+	}
+	vector<int> needed(h * w, -1);
+	for (auto& unit : cuts.units) {
+		int v = unit.first.first * w + unit.first.second;
+		if (needed[v] >= 0 && needed[v] != unit.second) {
+			return "colors " + color_name(needed[v], num_colors) + " and " + color_name(unit.second, num_colors) + " both have to pass through " + at(v / w, v % w);
+		}
+		needed[v] = unit.second;
+	}
+	return "";
+}
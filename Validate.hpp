@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Board.hpp"
+
+#include <string>
+
+// Throws unless every color 0.. up to the largest one on the board has
+// exactly two endpoints. Anything else cannot be encoded: Solver counts the
+// colors from the number of endpoints.
+void validate_endpoints(const endpoint_map& endpoints);
+
+// Throws unless b is well formed: rows of equal length, cells that are a
+// color, empty or a hole, and endpoints as validate_endpoints() wants them.
+void validate_board(const board& b);
+
+// Checks, each linear in the size of a board that validate_board() accepts,
+// that prove some boards unsolvable before anything is encoded: empty cells
+// with fewer than two neighbors, endpoints with none, endpoints that no
+// empty area connects, empty areas that no color can reach, the checkerboard
+// parity of the cell count, and cells that two colors both need to get
+// through. The last one is linear for each color. Returns the first reason
+// found, or an empty string if the board passes them all.
+std::string unsolvable_reason(const board& b);
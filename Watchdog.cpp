@@ -0,0 +1,56 @@
+#include "Watchdog.hpp"
+
+Watchdog::Watchdog(std::chrono::steady_clock::time_point deadline) : deadline(deadline) {
+	thread = std::thread(&Watchdog::run, this);
+}
+
+Watchdog::~Watchdog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
+	}
+	wake.notify_all();
+	thread.join();
+}
+
+void Watchdog::watch(Interruptible& s) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (expired) {
+		s.interrupt();
+	}
+	solvers.insert(&s);
+}
+
+void Watchdog::unwatch(Interruptible& s) {
+	std::lock_guard<std::mutex> lock(mutex);
+	solvers.erase(&s);
+	// Under the lock, so run() cannot interrupt s again after this
+	s.clear_interrupt();
+}
+
+void Watchdog::cancel() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		cancelled = true;
+	}
+	wake.notify_all();
+}
+
+void Watchdog::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+	auto woken = [this]() { return stopped || cancelled; };
+	// Waiting until time_point::max() overflows some implementations
+	if (deadline == std::chrono::steady_clock::time_point::max()) {
+		wake.wait(lock, woken);
+	}
+	else {
+		wake.wait_until(lock, deadline, woken);
+	}
+	if (stopped) {
+		return;
+	}
+	expired = true;
+	for (Interruptible* s : solvers) {
+		s->interrupt();
+	}
+}
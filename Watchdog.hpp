@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Solver.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+// Interrupts the solvers it watches once a deadline passes or cancel() is
+// called, from a thread of its own. Solvers are watched while they search;
+// one that starts watching after that is interrupted right away. Unwatching
+// clears the interrupt, so it only stops the solve it was aimed at.
+class Watchdog {
+private:
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::set<Interruptible*> solvers;
+	std::chrono::steady_clock::time_point deadline;
+	bool expired = false;
+	bool cancelled = false;
+	bool stopped = false;
+	std::thread thread;
+
+public:
+	// time_point::max() for no deadline
+	Watchdog(std::chrono::steady_clock::time_point deadline);
+	~Watchdog();
+	void watch(Interruptible& s);
+	void unwatch(Interruptible& s);
+	// Expires now, whatever the deadline
+	void cancel();
+
+private:
+	void run();
+};
@@ -0,0 +1,305 @@
+#include "Solver.hpp"
+#include "Board.hpp"
+#include "Options.hpp"
+#include "Decompose.hpp"
+#include "NativeSolver.hpp"
+#include "SolutionCode.hpp"
+#include "Watchdog.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ifstream;
+using std::string;
+using std::vector;
+using std::pair;
+
+using config = pair<string, SolverOptions>;
+
+void usage();
+
+const char* result_name(SolveResult result) {
+	switch (result) {
+	case SolveResult::solved:
+		return "sat";
+	case SolveResult::unsolvable:
+		return "unsat";
+	case SolveResult::out_of_memory:
+		return "memout";
+	default:
+		return "unknown";
+	}
+}
+
+// Builds the solver, then solves; encoded is set in between
+template <class S>
+SolveResult timed_solve(const board& b, const SolverOptions& options, std::chrono::steady_clock::time_point start,
+	std::chrono::steady_clock::time_point& encoded, SolverStats& st) {
+	S s(b, options);
+	encoded = std::chrono::steady_clock::now();
+	// The size columns measure the encoding, before Minisat simplifies and learns
+	st = s.stats();
+	// Like solve_board, the time limit covers encoding too
+	auto limit = std::chrono::duration<double>(options.timeout);
+	Watchdog watchdog(options.timeout > 0 ? start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(limit)
+		: std::chrono::steady_clock::time_point::max());
+	watchdog.watch(s);
+	SolveResult result = s.solve();
+	watchdog.unwatch(s);
+	SolverStats searched = s.stats();
+	st.decisions = searched.decisions;
+	st.conflicts = searched.conflicts;
+	st.propagations = searched.propagations;
+	return result;
+}
+
+// Each sweep compares variations of one feature on top of the options given
+// on the command line.
+vector<config> make_sweep(const string& name, SolverOptions base) {
+	vector<config> res;
+	if (name == "none") {
+		res.push_back(config("base", base));
+	}
+	else if (name == "decision") {
+		SolverOptions all = base;
+		all.decide_aux = true;
+		all.order = DecisionOrder::vsids;
+		res.push_back(config("vsids+aux", all));
+		const pair<string, DecisionOrder> orders[] = {
+			{ "vsids", DecisionOrder::vsids },
+			{ "color-major", DecisionOrder::color_major },
+			{ "endpoint-distance", DecisionOrder::endpoint_distance },
+		};
+		for (auto& order : orders) {
+			SolverOptions o = base;
+			o.decide_aux = false;
+			o.order = order.second;
+			res.push_back(config(order.first, o));
+		}
+	}
+	else if (name == "preprocess") {
+		SolverOptions off = base;
+		off.preprocess = false;
+		res.push_back(config("no-preprocess", off));
+		SolverOptions on = base;
+		on.preprocess = true;
+		res.push_back(config("preprocess", on));
+	}
+	else if (name == "cuts") {
+		const pair<string, CutLevel> levels[] = {
+			{ "no-cuts", CutLevel::none },
+			{ "cut-units", CutLevel::units },
+			{ "cut-pairs", CutLevel::pairs },
+		};
+		for (auto& level : levels) {
+			SolverOptions o = base;
+			o.cuts = level.second;
+			res.push_back(config(level.first, o));
+		}
+	}
+	else if (name == "redundant") {
+		for (int i = 0; i < 4; i++) {
+			SolverOptions o = base;
+			o.block_clauses = i & 1;
+			o.shortcut_clauses = i & 2;
+			const char* names[] = { "plain", "blocks", "shortcuts", "blocks+shortcuts" };
+			res.push_back(config(names[i], o));
+		}
+	}
+	else if (name == "acyclic") {
+		const pair<string, Acyclicity> encodings[] = {
+			{ "cycles-allowed", Acyclicity::none },
+			{ "unary-rank", Acyclicity::unary },
+			{ "binary-rank", Acyclicity::binary },
+		};
+		for (auto& encoding : encodings) {
+			SolverOptions o = base;
+			o.acyclic = encoding.second;
+			res.push_back(config(encoding.first, o));
+		}
+	}
+	else if (name == "encoding") {
+		SolverOptions one_hot = base;
+		one_hot.encoding = ColorEncoding::one_hot;
+		res.push_back(config("one-hot", one_hot));
+		SolverOptions log = base;
+		log.encoding = ColorEncoding::log;
+		res.push_back(config("log", log));
+	}
+	else if (name == "layout") {
+		const pair<string, VarLayout> layouts[] = {
+			{ "color-major", VarLayout::color_major },
+			{ "cell-major", VarLayout::cell_major },
+			{ "morton", VarLayout::morton },
+		};
+		for (auto& layout : layouts) {
+			SolverOptions o = base;
+			o.layout = layout.second;
+			res.push_back(config(layout.first, o));
+		}
+	}
+	else if (name == "backend") {
+		const pair<string, Backend> backends[] = {
+			{ "minisat", Backend::minisat },
+			{ "simp", Backend::simp },
+			{ "native", Backend::native },
+		};
+		for (auto& backend : backends) {
+			SolverOptions o = base;
+			o.backend = backend.second;
+			res.push_back(config(backend.first, o));
+		}
+	}
+	else if (name == "decompose") {
+		SolverOptions whole = base;
+		whole.decompose = false;
+		res.push_back(config("whole", whole));
+		SolverOptions regions = base;
+		regions.decompose = true;
+		res.push_back(config("regions", regions));
+	}
+	else {
+		throw std::runtime_error("Error: unknown sweep: " + name);
+	}
+	return res;
+}
+
+// Solves b, then encodes and decodes its solution for at least 100 ms each.
+// Prints the sizes of the code and of the solution rows, and the time per
+// encode and decode.
+void bench_codec(const string& file, const board& b, const SolverOptions& options) {
+	board solution;
+	SolverStats st;
+	vector<uint8_t> code;
+	SolveResult result = solve_board(b, options, solution, st);
+	if (result != SolveResult::solved || !encode_solution(b, solution, code)) {
+		cout << file << "\t" << (result == SolveResult::solved ? "no code" : result_name(result)) << endl;
+		return;
+	}
+	vector<uint8_t> parsed = solution_code_from_string(solution_code_to_string(code));
+	if (decode_solution(b, parsed.data(), parsed.size()) != solution) {
+		throw std::runtime_error("Error: " + file + " does not decode to its solution");
+	}
+	size_t row_bytes = 0;
+	for (auto& row : board_rows(solution)) {
+		row_bytes += row.size() + 1;
+	}
+	using clock = std::chrono::steady_clock;
+	auto min_time = std::chrono::milliseconds(100);
+	long encodes = 0;
+	auto start = clock::now();
+	auto end = start;
+	for (; end - start < min_time; end = clock::now()) {
+		for (int i = 0; i < 100; i++, encodes++) {
+			encode_solution(b, solution, code);
+		}
+	}
+	double encode_ns = std::chrono::duration<double, std::nano>(end - start).count() / encodes;
+	long decodes = 0;
+	start = clock::now();
+	for (end = start; end - start < min_time; end = clock::now()) {
+		for (int i = 0; i < 100; i++, decodes++) {
+			decode_solution(b, code.data(), code.size());
+		}
+	}
+	double decode_ns = std::chrono::duration<double, std::nano>(end - start).count() / decodes;
+	size_t cells = b.size() * (b.empty() ? 0 : b[0].size());
+	cout << file << "\t" << cells << "\t" << code.size() << "\t" << row_bytes << "\t" << encode_ns << "\t" << decode_ns
+		<< "\t" << cells / encode_ns * 1000 << "\t" << cells / decode_ns * 1000 << endl;
+}
+
+int main(int argc, char** argv) {
+	SolverOptions base;
+	base.progress_output = [](const string& line) { cerr << line; };
+	string sweep = "none";
+	bool codec = false;
+	vector<string> files;
+	try {
+		for (int i = 1; i < argc; i++) {
+			string arg = argv[i];
+			if (arg.compare(0, 8, "--sweep=") == 0) {
+				sweep = arg.substr(8);
+			}
+			else if (arg == "--codec") {
+				codec = true;
+			}
+			else if (!parse_solver_option(arg, base)) {
+				if (arg.compare(0, 2, "--") == 0) {
+					cerr << "Error: unknown option " << arg << endl;
+					usage();
+					return 1;
+				}
+				files.push_back(arg);
+			}
+		}
+		if (files.empty()) {
+			usage();
+			return 1;
+		}
+
+		if (codec) {
+			cout << "board\tcells\tcode_bytes\trow_bytes\tencode_ns\tdecode_ns\tencode_mcells_s\tdecode_mcells_s" << endl;
+			for (auto& file : files) {
+				ifstream f(file);
+				if (!f.is_open()) {
+					cerr << "Error: could not open input file " << file << endl;
+					return 1;
+				}
+				bench_codec(file, read_board(f), base);
+			}
+			return 0;
+		}
+
+		vector<config> configs = make_sweep(sweep, base);
+		cout << "board\tconfig\tvars\tdvars\tclauses\tliterals\tdecisions\tconflicts\tresult\tfixed\tencode_ms\tsolve_ms" << endl;
+		for (auto& file : files) {
+			ifstream f(file);
+			if (!f.is_open()) {
+				cerr << "Error: could not open input file " << file << endl;
+				return 1;
+			}
+			board b = read_board(f);
+			for (auto& conf : configs) {
+				auto start = std::chrono::steady_clock::now();
+				auto encoded = start;
+				SolveResult result;
+				SolverStats st;
+				if (conf.second.decompose) {
+					// Regions are encoded and solved together on their own threads
+					board solution;
+					result = solve_board(b, conf.second, solution, st);
+				}
+				else if (conf.second.backend == Backend::native) {
+					result = timed_solve<NativeSolver>(b, conf.second, start, encoded, st);
+				}
+				else {
+					result = timed_solve<Solver>(b, conf.second, start, encoded, st);
+				}
+				auto end = std::chrono::steady_clock::now();
+				cout << file << "\t" << conf.first << "\t" << st.vars << "\t" << st.decision_vars << "\t" << st.clauses << "\t" << st.literals
+					<< "\t" << st.decisions << "\t" << st.conflicts << "\t" << result_name(result)
+					<< "\t" << (st.free_cells ? 100.0 * st.fixed_cells / st.free_cells : 100.0) << "%"
+					<< "\t" << std::chrono::duration<double, std::milli>(encoded - start).count()
+					<< "\t" << std::chrono::duration<double, std::milli>(end - encoded).count() << endl;
+			}
+		}
+	}
+	catch (const std::runtime_error& e) {
+		cerr << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
+
+void usage() {
+	cout << "Usage: ./flowfree-bench [--sweep=<none|decision|encoding|layout|preprocess|cuts|redundant|acyclic|backend|decompose>] [solver options] <board.txt>..." << endl;
+	cout << "       ./flowfree-bench --codec [solver options] <board.txt>...   time the solution code of each board" << endl;
+	solver_options_usage(cout);
+}
\ No newline at end of file
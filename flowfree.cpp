@@ -0,0 +1,237 @@
+#define FLOWFREE_BUILDING
+#include "flowfree.h"
+
+#include "Board.hpp"
+#include "Decompose.hpp"
+#include "HintService.hpp"
+#include "Options.hpp"
+#include "Solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void set_error(char* error, size_t error_size, const std::string& message) {
+	if (!error || error_size == 0) {
+		return;
+	}
+	size_t n = std::min(message.size(), error_size - 1);
+	memcpy(error, message.data(), n);
+	error[n] = '\0';
+}
+
+board to_board(int rows, int cols, const int* cells) {
+	if (rows <= 0 || cols <= 0 || !cells) {
+		throw std::runtime_error("Error: empty board");
+	}
+	if ((uint64_t)rows * cols > (1u << 30)) {
+		throw std::runtime_error("Error: board is too large");
+	}
+	board b(rows, std::vector<int>(cols));
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			int value = cells[(size_t)r * cols + c];
+			if (value < hole) {
+				throw std::runtime_error("Error: invalid cell value " + std::to_string(value));
+			}
+			b[r][c] = value;
+		}
+	}
+	return b;
+}
+
+SolverOptions to_options(const char* const* options, int num_options) {
+	SolverOptions res;
+	for (int i = 0; i < num_options; i++) {
+		if (!options[i] || !parse_solver_option(options[i], res)) {
+			throw std::runtime_error(std::string("Error: unknown option ") + (options[i] ? options[i] : "(null)"));
+		}
+	}
+	return res;
+}
+
+int to_status(SolveResult res) {
+	switch (res) {
+	case SolveResult::solved:
+		return FLOWFREE_SOLVED;
+	case SolveResult::unsolvable:
+		return FLOWFREE_UNSOLVABLE;
+	case SolveResult::out_of_memory:
+		return FLOWFREE_OUT_OF_MEMORY;
+	default:
+		return FLOWFREE_INDETERMINATE;
+	}
+}
+
+}
+
+struct flowfree_hints {
+	int rows;
+	int cols;
+	HintService service;
+
+	flowfree_hints(int rows, int cols, const board& b, SolverOptions options) : rows(rows), cols(cols), service(b, options) {
+	}
+};
+
+int flowfree_api_version(void) {
+	return FLOWFREE_API_VERSION;
+}
+
+int flowfree_parse_board(const char* text, int* cells, size_t capacity, int* rows, int* cols, char* error, size_t error_size) {
+	try {
+		std::istringstream in(text ? text : "");
+		board b = read_board(in);
+		*rows = b.size();
+		*cols = b.empty() ? 0 : b[0].size();
+		if (b.empty()) {
+			throw std::runtime_error("Error: empty board");
+		}
+		if ((size_t)*rows * *cols > capacity || !cells) {
+			throw std::runtime_error("Error: board has " + std::to_string((size_t)*rows * *cols) + " cells, buffer holds " + std::to_string(capacity));
+		}
+		for (int r = 0; r < *rows; r++) {
+			std::copy(b[r].begin(), b[r].end(), cells + (size_t)r * *cols);
+		}
+		return 0;
+	}
+	catch (const std::bad_alloc&) {
+		set_error(error, error_size, "Error: out of memory");
+	}
+	catch (const std::exception& e) {
+		set_error(error, error_size, e.what());
+	}
+	return FLOWFREE_ERROR;
+}
+
+int flowfree_solve(int rows, int cols, const int* cells, const char* const* options, int num_options,
+	int* solution, flowfree_stats* stats, char* error, size_t error_size) {
+	try {
+		auto start = std::chrono::steady_clock::now();
+		board b = to_board(rows, cols, cells);
+		SolverOptions solver_options = to_options(options, num_options);
+		if (!solution) {
+			throw std::runtime_error("Error: no solution buffer");
+		}
+
+		board solved;
+		SolverStats st;
+		SolveResult res = solve_board(b, solver_options, solved, st);
+		if (res == SolveResult::solved) {
+			for (int r = 0; r < rows; r++) {
+				std::copy(solved[r].begin(), solved[r].end(), solution + (size_t)r * cols);
+			}
+		}
+		if (stats) {
+			flowfree_stats out;
+			memset(&out, 0, sizeof(out));
+			out.vars = st.vars;
+			out.decision_vars = st.decision_vars;
+			out.clauses = st.clauses;
+			out.literals = st.literals;
+			out.decisions = st.decisions;
+			out.conflicts = st.conflicts;
+			out.propagations = st.propagations;
+			out.fixed_cells = st.fixed_cells;
+			out.free_cells = st.free_cells;
+			out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			// Older callers know fewer fields
+			uint32_t size = std::min<uint32_t>(stats->size, sizeof(out));
+			out.size = size;
+			memcpy(stats, &out, size);
+		}
+		return to_status(res);
+	}
+	catch (const std::bad_alloc&) {
+		set_error(error, error_size, "Error: out of memory");
+	}
+	catch (const std::exception& e) {
+		set_error(error, error_size, e.what());
+	}
+	return FLOWFREE_ERROR;
+}
+
+int flowfree_verify(int rows, int cols, const int* cells, const int* solution, char* error, size_t error_size) {
+	try {
+		std::string reason;
+		if (verify_solution(to_board(rows, cols, cells), to_board(rows, cols, solution), &reason)) {
+			return FLOWFREE_SOLVED;
+		}
+		set_error(error, error_size, reason);
+		return FLOWFREE_NOT_A_SOLUTION;
+	}
+	catch (const std::bad_alloc&) {
+		set_error(error, error_size, "Error: out of memory");
+	}
+	catch (const std::exception& e) {
+		set_error(error, error_size, e.what());
+	}
+	return FLOWFREE_ERROR;
+}
+
+flowfree_hints* flowfree_hints_open(int rows, int cols, const int* cells, const char* const* options, int num_options,
+	char* error, size_t error_size) {
+	try {
+		return new flowfree_hints(rows, cols, to_board(rows, cols, cells), to_options(options, num_options));
+	}
+	catch (const std::bad_alloc&) {
+		set_error(error, error_size, "Error: out of memory");
+	}
+	catch (const std::exception& e) {
+		set_error(error, error_size, e.what());
+	}
+	return nullptr;
+}
+
+int flowfree_hints_next(flowfree_hints* hints, const int* state, int* row, int* col, int* color, char* error, size_t error_size) {
+	try {
+		if (!hints || !row || !col || !color) {
+			throw std::runtime_error("Error: missing argument");
+		}
+		Hint hint = hints->service.next_move(to_board(hints->rows, hints->cols, state));
+		*row = hint.row;
+		*col = hint.col;
+		*color = hint.color;
+		return to_status(hint.result);
+	}
+	catch (const std::bad_alloc&) {
+		set_error(error, error_size, "Error: out of memory");
+	}
+	catch (const std::exception& e) {
+		set_error(error, error_size, e.what());
+	}
+	return FLOWFREE_ERROR;
+}
+
+int flowfree_hints_forced(flowfree_hints* hints, const int* state, int* forced, char* error, size_t error_size) {
+	try {
+		if (!hints || !forced) {
+			throw std::runtime_error("Error: missing argument");
+		}
+		Hint hint = hints->service.forced_cells(to_board(hints->rows, hints->cols, state));
+		std::fill(forced, forced + (size_t)hints->rows * hints->cols, FLOWFREE_EMPTY);
+		if (hint.result == SolveResult::solved) {
+			for (int r = 0; r < hints->rows; r++) {
+				std::copy(hint.forced[r].begin(), hint.forced[r].end(), forced + (size_t)r * hints->cols);
+			}
+		}
+		return to_status(hint.result);
+	}
+	catch (const std::bad_alloc&) {
+		set_error(error, error_size, "Error: out of memory");
+	}
+	catch (const std::exception& e) {
+		set_error(error, error_size, e.what());
+	}
+	return FLOWFREE_ERROR;
+}
+
+void flowfree_hints_close(flowfree_hints* hints) {
+	delete hints;
+}
@@ -0,0 +1,125 @@
+/*
+ * C interface to the solver, for linking libflowfree into other programs.
+ * Boards go in and solutions come out as row-major arrays of ints in buffers
+ * owned by the caller: colors are 0.., empty cells FLOWFREE_EMPTY and cells
+ * that are not part of the board FLOWFREE_HOLE. Nothing is written to stdout
+ * or stderr, and no exception escapes; failures return FLOWFREE_ERROR with a
+ * message in the caller's error buffer.
+ *
+ * Only this header is a stable interface. Every function is safe to call
+ * from several threads at once, except that a flowfree_hints handle must
+ * only be used by one thread at a time.
+ */
+#ifndef FLOWFREE_H
+#define FLOWFREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(FLOWFREE_SHARED)
+#ifdef FLOWFREE_BUILDING
+#define FLOWFREE_API __declspec(dllexport)
+#else
+#define FLOWFREE_API __declspec(dllimport)
+#endif
+#else
+#define FLOWFREE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLOWFREE_API_VERSION 3
+
+/* Results of flowfree_solve() and the hint functions */
+#define FLOWFREE_SOLVED 0
+#define FLOWFREE_UNSOLVABLE 1
+#define FLOWFREE_INDETERMINATE 2  /* A time or search budget ran out */
+#define FLOWFREE_OUT_OF_MEMORY 3  /* The search needed more than --memory-limit */
+#define FLOWFREE_NOT_A_SOLUTION 4  /* From flowfree_verify() */
+#define FLOWFREE_ERROR (-1)
+
+#define FLOWFREE_EMPTY (-1)
+#define FLOWFREE_HOLE (-2)
+
+/*
+ * Fields are only ever added at the end. Set size to sizeof(flowfree_stats)
+ * before passing one in; fields past it are left alone.
+ */
+typedef struct flowfree_stats {
+	uint32_t size;
+	uint64_t vars;
+	uint64_t decision_vars;
+	uint64_t clauses;
+	uint64_t literals;
+	uint64_t decisions;
+	uint64_t conflicts;
+	uint64_t propagations;
+	int32_t fixed_cells;  /* Non-endpoint cells resolved by preprocessing */
+	int32_t free_cells;   /* Non-endpoint cells on the board */
+	double seconds;       /* Wall-clock time of the solve */
+} flowfree_stats;
+
+/* FLOWFREE_API_VERSION of the library actually linked */
+FLOWFREE_API int flowfree_api_version(void);
+
+/*
+ * Parses a board in the text format of flowfree-cli into cells, which holds
+ * capacity ints. rows and cols are set even if the board does not fit, so
+ * the caller can retry with a larger buffer. Returns 0 or FLOWFREE_ERROR.
+ */
+FLOWFREE_API int flowfree_parse_board(const char* text, int* cells, size_t capacity, int* rows, int* cols,
+	char* error, size_t error_size);
+
+/*
+ * Solves a rows x cols board. options are flowfree-cli solver flags such as
+ * "--timeout=5" or "--encoding=log" (num_options of them, options may be
+ * NULL if there are none); progress reporting is not available. solution
+ * must hold rows * cols ints and is only filled in if the board is solved.
+ * stats and error may be NULL. Returns one of the results above.
+ */
+FLOWFREE_API int flowfree_solve(int rows, int cols, const int* cells, const char* const* options, int num_options,
+	int* solution, flowfree_stats* stats, char* error, size_t error_size);
+
+/*
+ * Checks without a solver that solution (rows * cols ints) solves the board
+ * (API version 3). Returns FLOWFREE_SOLVED if it does, or
+ * FLOWFREE_NOT_A_SOLUTION with the reason in error.
+ */
+FLOWFREE_API int flowfree_verify(int rows, int cols, const int* cells, const int* solution, char* error, size_t error_size);
+
+/*
+ * Hints for a game in progress (API version 2). A handle keeps a solver for
+ * one board, so that each request against the player's drawing takes
+ * milliseconds after the first. state holds rows * cols ints: the color the
+ * player drew in each cell, FLOWFREE_EMPTY elsewhere. The result is
+ * FLOWFREE_SOLVED if the drawing can still be completed,
+ * FLOWFREE_UNSOLVABLE if it cannot, or as for flowfree_solve().
+ */
+typedef struct flowfree_hints flowfree_hints;
+
+/* options as for flowfree_solve(). Returns NULL on failure. */
+FLOWFREE_API flowfree_hints* flowfree_hints_open(int rows, int cols, const int* cells, const char* const* options,
+	int num_options, char* error, size_t error_size);
+
+/*
+ * A cell whose color is forced and that extends one of the paths; row is -1
+ * if none was found.
+ */
+FLOWFREE_API int flowfree_hints_next(flowfree_hints* hints, const int* state, int* row, int* col, int* color,
+	char* error, size_t error_size);
+
+/*
+ * Fills forced (rows * cols ints) with the color forced in each empty cell,
+ * FLOWFREE_EMPTY where none was shown.
+ */
+FLOWFREE_API int flowfree_hints_forced(flowfree_hints* hints, const int* state, int* forced, char* error, size_t error_size);
+
+FLOWFREE_API void flowfree_hints_close(flowfree_hints* hints);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
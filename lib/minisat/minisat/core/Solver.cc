@@ -19,6 +19,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 **************************************************************************************************/
 
 #include <math.h>
+#include <algorithm>
 
 #include "minisat/mtl/Sort.h"
 #include "minisat/core/Solver.h"
@@ -80,6 +81,8 @@ Solver::Solver() :
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0)
   , dec_vars(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
 
+  , progress_conflicts (100)
+
   , ok                 (true)
   , cla_inc            (1)
   , var_inc            (1)
@@ -96,6 +99,8 @@ Solver::Solver() :
   , conflict_budget    (-1)
   , propagation_budget (-1)
   , asynch_interrupt   (false)
+  , memory_limit       (0)
+  , mem_exceeded       (false)
 {}
 
 
@@ -569,6 +574,43 @@ void Solver::reduceDB()
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  shedLearnts : ()  ->  [bool]
+|
+|  Description:
+|    Called when memory use is over the limit. Halves the learnt clause database until enough is
+|    freed or nothing more can be removed and compacts the clause arena. The database is then kept
+|    under half the size at which memory ran out, or the usual initial limit if that is smaller,
+|    but never under what is left: pinning the limit at the new size, which can be nothing, would
+|    have 'reduceDB()' run after every conflict. Returns false if memory use is still over the
+|    limit.
+|________________________________________________________________________________________________@*/
+bool Solver::shedLearnts()
+{
+    int over = learnts.size();
+    int before;
+    do {
+        before = learnts.size();
+        reduceDB();
+    } while (learnts.size() < before && memUsed() > memory_limit);
+    garbageCollect();
+    max_learnts = std::max((double)learnts.size(), std::min(nClauses() * learntsize_factor, over / 2.0));
+    return memUsed() <= memory_limit;
+}
+
+
+uint64_t Solver::memUsed() const
+{
+    // Per variable: assignment, reason, activity, flags, heap and trail entries, two watch lists
+    const uint64_t var_bytes = 80;
+    uint64_t watchers = 2 * ((uint64_t)clauses.size() + learnts.size()) * sizeof(Watcher);
+    return (uint64_t)ca.capacity() * ClauseAllocator::Unit_Size
+         + ((uint64_t)clauses.capacity() + learnts.capacity()) * sizeof(CRef)
+         + (uint64_t)nVars() * var_bytes + watchers;
+}
+
+
 void Solver::removeSatisfied(vec<CRef>& cs)
 {
     auto i = cs.begin();
@@ -675,6 +717,9 @@ lbool Solver::search(int nof_conflicts)
             varDecayActivity();
             claDecayActivity();
 
+            if (progress_callback && conflicts % progress_conflicts == 0)
+                progress_callback();
+
             if (--learntsize_adjust_cnt == 0){
                 learntsize_adjust_confl *= learntsize_adjust_inc;
                 learntsize_adjust_cnt    = (int)learntsize_adjust_confl;
@@ -703,6 +748,13 @@ lbool Solver::search(int nof_conflicts)
                 // Reduce the set of learnt clauses:
                 reduceDB();
 
+            if (memory_limit > 0 && memUsed() > memory_limit && !shedLearnts()){
+                // Out of memory even without learnt clauses:
+                mem_exceeded = true;
+                progress_estimate = progressEstimate();
+                cancelUntil(0);
+                return l_Undef; }
+
             Lit next = lit_Undef;
             while (decisionLevel() < assumptions.size()){
                 // Perform user provided assumption:
@@ -788,6 +840,9 @@ lbool Solver::solve_()
 
     solves++;
 
+    mem_exceeded = memory_limit > 0 && memUsed() > memory_limit;
+    if (mem_exceeded) return l_Undef;
+
     max_learnts               = nClauses() * learntsize_factor;
     learntsize_adjust_confl   = learntsize_adjust_start_confl;
     learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
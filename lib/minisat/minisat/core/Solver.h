@@ -21,6 +21,9 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef Minisat_Solver_h
 #define Minisat_Solver_h
 
+#include <atomic>
+#include <functional>
+
 #include "minisat/mtl/Vec.h"
 #include "minisat/mtl/Heap.h"
 #include "minisat/mtl/Alg.h"
@@ -78,6 +81,7 @@ public:
     //
     void    setPolarity    (Var v, bool b); // Declare which polarity the decision heuristic should use for a variable. Requires mode 'polarity_user'.
     void    setDecisionVar (Var v, bool b); // Declare if a variable should be eligible for selection in the decision heuristic.
+    void    setActivity    (Var v, double a); // Seed the activity the decision heuristic orders a variable by.
 
     // Read state:
     //
@@ -98,6 +102,9 @@ public:
     void    budgetOff();
     void    interrupt();          // Trigger a (potentially asynchronous) interruption of the solver.
     void    clearInterrupt();     // Clear interrupt indicator flag.
+    void    setMemLimit(uint64_t bytes); // 0 means no limit.
+    bool    memLimitReached() const;     // The last search stopped because of the memory limit.
+    uint64_t memUsed() const;     // Estimated bytes held by clauses, watches and per-variable data.
 
     // Memory managment:
     //
@@ -138,6 +145,13 @@ public:
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
     uint64_t dec_vars, clauses_literals, learnts_literals, max_literals, tot_literals;
 
+    // Progress reporting:
+    //
+    std::function<void()> progress_callback; // Called from search() every 'progress_conflicts' conflicts.
+    int       progress_conflicts;
+    lbool     fixedValue (Var x) const;      // The value of 'x' if it is fixed at decision level 0, l_Undef otherwise.
+    double    progress   ()      const;      // Estimated fraction of the search space covered.
+
 protected:
 
     // Helper structures:
@@ -208,7 +222,9 @@ protected:
     //
     int64_t             conflict_budget;    // -1 means no budget.
     int64_t             propagation_budget; // -1 means no budget.
-    bool                asynch_interrupt;
+    std::atomic<bool>   asynch_interrupt;   // Set from other threads by interrupt().
+    uint64_t            memory_limit;       // 0 means no limit.
+    bool                mem_exceeded;
 
     // Main internal methods:
     //
@@ -225,6 +241,7 @@ protected:
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
     lbool    solve_           ();                                                      // Main solve method (assumptions given in 'assumptions').
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
+    bool     shedLearnts      ();                                                      // Reduce learnt clauses until under the memory limit.
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
     void     rebuildOrderHeap ();
 
@@ -323,6 +340,8 @@ inline int      Solver::decisionLevel ()      const   { return trail_lim.size();
 inline uint32_t Solver::abstractLevel (Var x) const   { return 1 << (level(x) & 31); }
 inline lbool    Solver::value         (Var x) const   { return assigns[x]; }
 inline lbool    Solver::value         (Lit p) const   { return assigns[var(p)] ^ sign(p); }
+inline lbool    Solver::fixedValue    (Var x) const   { return level(x) == 0 ? assigns[x] : l_Undef; }
+inline double   Solver::progress      ()      const   { return progressEstimate(); }
 inline lbool    Solver::modelValue    (Var x) const   { return model[x]; }
 inline lbool    Solver::modelValue    (Lit p) const   { return model[var(p)] ^ sign(p); }
 inline int      Solver::nAssigns      ()      const   { return trail.size(); }
@@ -339,13 +358,21 @@ inline void     Solver::setDecisionVar(Var v, bool b)
     decision[v] = b;
     insertVarOrder(v);
 }
+inline void     Solver::setActivity   (Var v, double a)
+{
+    activity[v] = a;
+    if (order_heap.inHeap(v))
+        order_heap.update(v);
+}
 inline void     Solver::setConfBudget(int64_t x){ conflict_budget    = conflicts    + x; }
 inline void     Solver::setPropBudget(int64_t x){ propagation_budget = propagations + x; }
 inline void     Solver::interrupt(){ asynch_interrupt = true; }
 inline void     Solver::clearInterrupt(){ asynch_interrupt = false; }
 inline void     Solver::budgetOff(){ conflict_budget = propagation_budget = -1; }
+inline void     Solver::setMemLimit(uint64_t bytes){ memory_limit = bytes; }
+inline bool     Solver::memLimitReached() const { return mem_exceeded; }
 inline bool     Solver::withinBudget() const {
-    return !asynch_interrupt &&
+    return !asynch_interrupt && !mem_exceeded &&
            (conflict_budget    < 0 || conflicts < (uint64_t)conflict_budget) &&
            (propagation_budget < 0 || propagations < (uint64_t)propagation_budget); }
 
@@ -291,8 +291,8 @@ void SimpSolver::gatherTouchedClauses()
         if (ca[subsumption_queue[i]].mark() == 0)
             ca[subsumption_queue[i]].mark(2);
 
-    for (auto& t : touched) {
-        if (t) {
+    for (i = 0; i < touched.size(); i++) {
+        if (touched[i]) {
             const vec<CRef>& cs = occurs.lookup(i);
             for (auto const& ref : cs) {
                 if (ca[ref].mark() == 0) {
@@ -300,7 +300,7 @@ void SimpSolver::gatherTouchedClauses()
                     ca[ref].mark(2);
                 }
             }
-            t = 0;
+            touched[i] = 0;
         }
     }
 
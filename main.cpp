@@ -1,8 +1,20 @@
 #include <minisat/core/Solver.h>
+#include <minisat/core/OutOfMemoryException.h>
 #include "BoolExpr.hpp"
 #include "Solver.hpp"
-#include <cctype>
+#include "Board.hpp"
+#include "BoardPack.hpp"
+#include "Options.hpp"
+#include "Decompose.hpp"
+#include "SolutionCache.hpp"
+#include "SolutionCode.hpp"
+#include "Validate.hpp"
+#include <chrono>
 #include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
 
 using std::cout;
 using std::endl;
@@ -11,125 +23,530 @@ using std::make_shared;
 using std::to_string;
 using std::cerr;
 using std::ifstream;
+using std::string;
+using std::vector;
+
+// Exit codes. With several boards the first one that is not solved decides.
+const int exit_solved = 0;
+const int exit_error = 1;
+const int exit_gave_up = 2;  // Time, search or memory limit
+const int exit_unsolvable = 3;
+
+// text is for people and waits for a key press at the end unless --no-wait
+// is given. json and line write one record per board, for scripts.
+enum class OutputFormat {
+	text,
+	json,
+	line
+};
+
+struct BoardRun {
+	string name;
+	SolveResult result = SolveResult::indeterminate;
+	board solution;
+	SolverStats stats = SolverStats();
+	double ms = 0;
+	bool cached = false;
+	vector<std::pair<int, int>> conflicts;  // Hints that rule out every solution
+	string reason;  // Why the board is unsolvable, if that was found without solving
+	string code;  // The solution code, with --solution=code, if the solution has one
+	string error;  // Set if the board could not be read or solved
+};
 
-void print_char_board(char_board b);
-char_board board_to_char_board(board b);
-unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> endpoints_from_board(board b);
-board read_board(std::istream& in);
 void usage();
 
+const char* status_name(const BoardRun& run) {
+	if (!run.error.empty()) {
+		return "error";
+	}
+	switch (run.result) {
+	case SolveResult::solved:
+		return "solved";
+	case SolveResult::unsolvable:
+		return "unsolvable";
+	case SolveResult::out_of_memory:
+		return "memout";
+	default:
+		return "timeout";
+	}
+}
+
+int exit_code(const BoardRun& run) {
+	if (!run.error.empty()) {
+		return exit_error;
+	}
+	switch (run.result) {
+	case SolveResult::solved:
+		return exit_solved;
+	case SolveResult::unsolvable:
+		return exit_unsolvable;
+	default:
+		return exit_gave_up;
+	}
+}
+
+string json_string(const string& s) {
+	string res = "\"";
+	for (char ch : s) {
+		if (ch == '"' || ch == '\\') {
+			res += '\\';
+			res += ch;
+		}
+		else if ((unsigned char)ch < 0x20) {
+			const char* hex = "0123456789abcdef";
+			res += "\\u00";
+			res += hex[ch >> 4];
+			res += hex[ch & 15];
+		}
+		else {
+			res += ch;
+		}
+	}
+	return res + "\"";
+}
+
+// One JSON object per line
+void write_json(std::ostream& out, const BoardRun& run) {
+	out << "{\"board\":" << json_string(run.name) << ",\"status\":\"" << status_name(run) << "\"";
+	if (!run.error.empty()) {
+		out << ",\"error\":" << json_string(run.error) << "}\n";
+		return;
+	}
+	out << ",\"time_ms\":" << run.ms << ",\"cached\":" << (run.cached ? "true" : "false")
+		<< ",\"stats\":{\"vars\":" << run.stats.vars << ",\"clauses\":" << run.stats.clauses << ",\"decisions\":" << run.stats.decisions
+		<< ",\"conflicts\":" << run.stats.conflicts << ",\"propagations\":" << run.stats.propagations
+		<< ",\"fixed_cells\":" << run.stats.fixed_cells << ",\"free_cells\":" << run.stats.free_cells << "}";
+	if (!run.code.empty()) {
+		out << ",\"code\":" << json_string(run.code);
+	}
+	else if (run.result == SolveResult::solved) {
+		out << ",\"solution\":[";
+		vector<string> rows = board_rows(run.solution);
+		for (size_t i = 0; i < rows.size(); i++) {
+			out << (i ? "," : "") << json_string(rows[i]);
+		}
+		out << "]";
+	}
+	if (!run.reason.empty()) {
+		out << ",\"reason\":" << json_string(run.reason);
+	}
+	if (!run.conflicts.empty()) {
+		out << ",\"conflicts\":[";
+		for (size_t i = 0; i < run.conflicts.size(); i++) {
+			out << (i ? "," : "") << "[" << run.conflicts[i].first + 1 << "," << run.conflicts[i].second + 1 << "]";
+		}
+		out << "]";
+	}
+	out << "}\n";
+}
+
+// Tab-separated: board, status, milliseconds, conflicts, decisions, and the
+// solution rows joined by '/' or its code as code:... (or the error message,
+// why the board is unsolvable, or the conflicting hints as hints:row,column;...)
+void write_line(std::ostream& out, const BoardRun& run) {
+	out << run.name << "\t" << status_name(run);
+	if (!run.error.empty()) {
+		out << "\t\t\t\t" << run.error << "\n";
+		return;
+	}
+	out << "\t" << run.ms << "\t" << run.stats.conflicts << "\t" << run.stats.decisions << "\t";
+	if (!run.code.empty()) {
+		out << "code:" << run.code;
+	}
+	else if (run.result == SolveResult::solved) {
+		vector<string> rows = board_rows(run.solution);
+		for (size_t i = 0; i < rows.size(); i++) {
+			out << (i ? "/" : "") << rows[i];
+		}
+	}
+	out << run.reason;
+	for (size_t i = 0; i < run.conflicts.size(); i++) {
+		out << (i ? ";" : "hints:") << run.conflicts[i].first + 1 << "," << run.conflicts[i].second + 1;
+	}
+	out << "\n";
+}
+
+bool has_hints(const board& hints) {
+	for (auto& row : hints) {
+		for (int color : row) {
+			if (color >= 0) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// Boards with hints bypass the cache, which holds whole boards only.
+// solve_board() repeats the quick checks, which cost next to nothing.
+void solve_one(const board& b, const board& hints, const SolverOptions& options, SolutionCache* cache, bool code, BoardRun& run) {
+	auto start = std::chrono::steady_clock::now();
+	try {
+		validate_board(b);
+		run.reason = unsolvable_reason(b);
+		if (!run.reason.empty()) {
+			run.result = SolveResult::unsolvable;
+		}
+		else if (has_hints(hints)) {
+			run.result = solve_board(b, hints, options, run.solution, run.stats, run.conflicts);
+		}
+		else {
+			run.cached = cache && cache->find(b, options, run.result, run.solution);
+			if (!run.cached) {
+				run.result = solve_board(b, options, run.solution, run.stats);
+				if (cache) {
+					cache->insert(b, options, run.result, run.solution);
+				}
+			}
+		}
+		vector<uint8_t> bytes;
+		if (code && run.result == SolveResult::solved && encode_solution(b, run.solution, bytes)) {
+			run.code = solution_code_to_string(bytes);
+		}
+	}
+	// Minisat's allocator throws its own exception when memory runs out
+	catch (const Minisat::OutOfMemoryException&) {
+		run.error = "Error: out of memory";
+	}
+	catch (const std::bad_alloc&) {
+		run.error = "Error: out of memory";
+	}
+	catch (const std::exception& e) {
+		run.error = e.what();
+	}
+	run.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// After a bad board in a stream, skips to the blank line that ends it
+void skip_board(std::istream& in) {
+	string line;
+	while (std::getline(in, line) && line.find_first_not_of(" \t\r") != string::npos) {
+	}
+}
+
 int main(int argc, char** argv) {
-	if (argc > 2) {
-		cerr << "Error: number of arguments greater than 1" << endl;
-		usage();
-		return 1;
+	SolverOptions options;
+	options.progress_output = [](const std::string& line) { cerr << line; };
+	vector<const char*> files;
+	std::string cache_file;
+	std::string verify_file;
+	int cache_size_mb = 64;
+	OutputFormat format = OutputFormat::text;
+	bool solution_code = false;
+	bool wait = true;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		try {
+			if (arg.compare(0, 8, "--cache=") == 0) {
+				cache_file = arg.substr(8);
+				continue;
+			}
+			if (arg.compare(0, 9, "--verify=") == 0) {
+				verify_file = arg.substr(9);
+				continue;
+			}
+			if (arg.compare(0, 13, "--cache-size=") == 0) {
+				string value = arg.substr(13);
+				size_t end = 0;
+				try {
+					cache_size_mb = std::stoi(value, &end);
+				}
+				catch (const std::logic_error&) {
+					end = 0;
+				}
+				if (end == 0 || end != value.size() || cache_size_mb <= 0) {
+					throw std::runtime_error("Error: invalid cache size: " + value);
+				}
+				continue;
+			}
+			if (arg == "--output=text" || arg == "--output=json" || arg == "--output=line") {
+				format = arg == "--output=json" ? OutputFormat::json : arg == "--output=line" ? OutputFormat::line : OutputFormat::text;
+				continue;
+			}
+			if (arg.compare(0, 9, "--output=") == 0) {
+				throw std::runtime_error("Error: unknown output format: " + arg.substr(9));
+			}
+			if (arg == "--solution=rows" || arg == "--solution=code") {
+				solution_code = arg == "--solution=code";
+				continue;
+			}
+			if (arg.compare(0, 11, "--solution=") == 0) {
+				throw std::runtime_error("Error: unknown solution format: " + arg.substr(11));
+			}
+			if (arg == "--no-wait") {
+				wait = false;
+				continue;
+			}
+			if (parse_solver_option(argv[i], options)) {
+				continue;
+			}
+		}
+		catch (const std::bad_alloc&) {
+			cerr << "Error: out of memory" << endl;
+			return exit_error;
+		}
+		catch (const std::exception& e) {
+			cerr << e.what() << endl;
+			return exit_error;
+		}
+		if (argv[i][0] == '-') {
+			cerr << "Error: unexpected argument " << argv[i] << endl;
+			usage();
+			return exit_error;
+		}
+		files.push_back(argv[i]);
+	}
+	if (format == OutputFormat::text && files.size() > 1) {
+		cerr << "Error: several boards need --output=json or --output=line" << endl;
+		return exit_error;
+	}
+	if (!verify_file.empty() && (format != OutputFormat::text || files.size() != 1)) {
+		cerr << "Error: --verify checks one board file with text output" << endl;
+		return exit_error;
+	}
+
+	std::unique_ptr<SolutionCache> cache;
+	try {
+		if (!cache_file.empty()) {
+			cache.reset(new SolutionCache(cache_file, cache_size_mb));
+		}
 	}
+	catch (const std::bad_alloc&) {
+		cerr << "Error: out of memory" << endl;
+		return exit_error;
+	}
+	catch (const std::exception& e) {
+		cerr << e.what() << endl;
+		return exit_error;
+	}
+
+	if (format != OutputFormat::text) {
+		// Records are flushed when the program ends, not one by one
+		std::ios::sync_with_stdio(false);
+		auto write = format == OutputFormat::json ? write_json : write_line;
+		int code = exit_solved;
+		auto report = [&](const BoardRun& run) {
+			write(cout, run);
+			if (code == exit_solved) {
+				code = exit_code(run);
+			}
+		};
+		for (const char* file : files) {
+			if (is_board_pack(file)) {
+				// Every board of the pack, named file:N
+				std::unique_ptr<BoardPack> pack;
+				BoardRun run;
+				run.name = file;
+				try {
+					pack.reset(new BoardPack(file));
+				}
+				catch (const std::bad_alloc&) {
+					run.error = "Error: out of memory";
+					report(run);
+					continue;
+				}
+				catch (const std::exception& e) {
+					run.error = e.what();
+					report(run);
+					continue;
+				}
+				for (uint64_t i = 0; i < pack->count(); i++) {
+					BoardRun run;
+					run.name = string(file) + ":" + to_string(i + 1);
+					try {
+						solve_one(pack->get(i), board(), options, cache.get(), solution_code, run);
+					}
+					catch (const std::bad_alloc&) {
+						run.error = "Error: out of memory";
+					}
+					catch (const std::exception& e) {
+						run.error = e.what();
+					}
+					report(run);
+				}
+				continue;
+			}
+			BoardRun run;
+			run.name = file;
+			ifstream f(file);
+			if (!f.is_open()) {
+				run.error = "Error: could not open input file";
+			}
+			else {
+				try {
+					board hints;
+					board b = read_board(f, hints);
+					solve_one(b, hints, options, cache.get(), solution_code, run);
+				}
+				catch (const std::bad_alloc&) {
+					run.error = "Error: out of memory";
+				}
+				catch (const std::exception& e) {
+					run.error = e.what();
+				}
+			}
+			report(run);
+		}
+		// Without files, every board on stdin, each ended by a blank line
+		for (int index = 1; files.empty() && std::cin; index++) {
+			BoardRun run;
+			run.name = "stdin:" + to_string(index);
+			board b;
+			board hints;
+			try {
+				b = read_board(std::cin, hints);
+			}
+			catch (const std::bad_alloc&) {
+				run.error = "Error: out of memory";
+				skip_board(std::cin);
+				report(run);
+				continue;
+			}
+			catch (const std::exception& e) {
+				run.error = e.what();
+				skip_board(std::cin);
+				report(run);
+				continue;
+			}
+			if (b.empty()) {
+				index--;
+				continue;
+			}
+			solve_one(b, hints, options, cache.get(), solution_code, run);
+			report(run);
+		}
+		cout.flush();
+		return code;
+	}
+
 	board b;
-	if (argc == 2) {
-		char* file = argv[1];
-		ifstream f(file);
+	board hints;
+	if (!files.empty() && is_board_pack(files[0])) {
+		cerr << "Error: board packs need --output=json or --output=line" << endl;
+		return exit_error;
+	}
+	if (!files.empty()) {
+		ifstream f(files[0]);
 		if (f.is_open()) {
 			try {
-				b = read_board(f);
+				b = read_board(f, hints);
+			}
+			catch (const std::bad_alloc&) {
+				cerr << "Error: out of memory" << endl;
+				return exit_error;
 			}
-			catch (const std::runtime_error& e) {
+			catch (const std::exception& e) {
 				cerr << e.what() << endl;
-				return 1;
+				return exit_error;
 			}
 		}
 		else {
 			cerr << "Error: could not open input file" << endl;
 			usage();
-			return 1;
+			return exit_error;
 		}
 	}
 	else {
-		cout << "Input board below:" << endl;
+		if (wait) {
+			cout << "Input board below:" << endl;
+		}
 		try {
-			b = read_board(std::cin);
+			b = read_board(std::cin, hints);
+		}
+		catch (const std::bad_alloc&) {
+			cerr << "Error: out of memory" << endl;
+			return exit_error;
 		}
-		catch (const std::runtime_error& e) {
+		catch (const std::exception& e) {
 			cerr << e.what() << endl;
-			return 1;
+			return exit_error;
 		}
 	}
-	unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> endpoints = endpoints_from_board(b);
-	int n = b.size();
-
-	Solver s(n, endpoints);
-	if (s.solve()) {
-		cout << "Solved!" << endl;
-		print_char_board(board_to_char_board(s.get_solution()));
-	}
-	else {
-		cout << "Board is not solvable" << endl;
-	}
-	cout << endl << "Press any key to close the program . . ." << endl;
-	getchar();
-}
-
-void usage() {
-	cout << "Usage: ./flowfree-cli <inputfile.txt>" << endl;
-}
-
-board read_board(std::istream& in) {
-	board parsed;
-	std::string line;
-	int num_lines = 1;
-	while (std::getline(in, line)) {
-		if (line.size() == 0) {
-			break;
+	if (!verify_file.empty()) {
+		ifstream f(verify_file);
+		if (!f.is_open()) {
+			cerr << "Error: could not open solution file" << endl;
+			return exit_error;
 		}
-		vector<int> row;
-		for (size_t ci = 0; ci < line.size(); ++ci) {
-			char c = line[ci];
-			if (c == '.') {
-				row.push_back(-1);
+		string reason;
+		try {
+			// Either solution rows or a code as a line record writes it
+			board solution;
+			string first;
+			std::getline(f, first);
+			if (!first.empty() && first.back() == '\r') {
+				first.pop_back();
+			}
+			if (first.compare(0, 5, "code:") == 0) {
+				vector<uint8_t> bytes = solution_code_from_string(first.substr(5));
+				solution = decode_solution(b, bytes.data(), bytes.size());
 			}
 			else {
-				if (!isalpha(c)) {
-					throw std::runtime_error("Line #" + std::to_string(num_lines) + " contains invalid character: " + c);
-				}
-				c = tolower(c);
-				row.push_back(c - 'a');
+				f.clear();
+				f.seekg(0);
+				solution = read_board(f);
+			}
+			if (verify_solution(b, solution, &reason)) {
+				cout << "Valid solution" << endl;
+				return exit_solved;
 			}
 		}
-		parsed.push_back(row);
-		num_lines++;
-	}
-	return parsed;
-}
-
-void print_char_board(char_board b) {
-	int n = b.size();
-	for (int i = 0; i < n; i++) {
-		for (int j = 0; j < n; j++) {
-			cout << b[i][j] << " ";
+		catch (const std::bad_alloc&) {
+			cerr << "Error: out of memory" << endl;
+			return exit_error;
 		}
-		cout << endl;
+		catch (const std::exception& e) {
+			cerr << e.what() << endl;
+			return exit_error;
+		}
+		cout << "Not a solution: " << reason << endl;
+		return exit_unsolvable;
 	}
-}
-
-unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> endpoints_from_board(board b) {
-	unordered_map<pair<int, int>, int, boost::hash<pair<int, int>>> res;
-	for (int r = 0; r < b.size(); r++) {
-		for (int c = 0; c < b[0].size(); c++) {
-			if (b[r][c] >= 0) {
-				res[pair<int, int>(r, c)] = b[r][c];
+	BoardRun run;
+	solve_one(b, hints, options, cache.get(), false, run);
+	if (!run.error.empty()) {
+		cerr << run.error << endl;
+		return exit_error;
+	}
+	if (run.result == SolveResult::solved) {
+		cout << "Solved!" << endl;
+		print_board(run.solution);
+	}
+	else if (run.result == SolveResult::unsolvable) {
+		cout << "Board is not solvable" << (run.reason.empty() ? "" : ": " + run.reason) << endl;
+		if (!run.conflicts.empty()) {
+			cout << "Conflicting hints (row, column):";
+			for (auto& cell : run.conflicts) {
+				cout << " (" << cell.first + 1 << ", " << cell.second + 1 << ")";
 			}
+			cout << endl;
 		}
 	}
-	return res;
+	else if (run.result == SolveResult::out_of_memory) {
+		cout << "Gave up: memory limit reached" << endl;
+	}
+	else {
+		cout << "Gave up: time or search budget exhausted" << endl;
+	}
+	if (wait) {
+		cout << endl << "Press any key to close the program . . ." << endl;
+		getchar();
+	}
+	return exit_code(run);
 }
 
-char_board board_to_char_board(board b) {
-	char_board res;
-	for (int r = 0; r < b.size(); r++) {
-		vector<char> row;
-		for (int c = 0; c < b[0].size(); c++) {
-			row.push_back('a' + b[r][c]);
-		}
-		res.push_back(row);
-	}
-	return res;
-}
\ No newline at end of file
+void usage() {
+	cout << "Usage: ./flowfree-cli [options] <inputfile.txt>" << endl;
+	cout << "       ./flowfree-cli --output=<json|line> [options] [<inputfile.txt>...]" << endl;
+	cout << "  --output=<text|json|line>                      text for people (default), or one record per board;" << endl;
+	cout << "                                                 without files, every board on stdin is solved" << endl;
+	cout << "  --solution=<rows|code>                         solutions in json and line records as rows (default)," << endl;
+	cout << "                                                 or as a code of two bits per cell when there is one" << endl;
+	cout << "  --no-wait                                      do not prompt or wait for a key press (text output)" << endl;
+	cout << "  --cache=<file>                                 reuse results kept in this file, and add new ones" << endl;
+	cout << "  --cache-size=<MB>                              size of a newly created cache file (default 64)" << endl;
+	cout << "  --verify=<solution.txt>                        check a solution of the board instead of solving it;" << endl;
+	cout << "                                                 rows, or code:... as --solution=code writes it;" << endl;
+	cout << "                                                 exit code 0 if it is one, 3 if not" << endl;
+	solver_options_usage(cout);
+}
@@ -0,0 +1,101 @@
+#include "Board.hpp"
+#include "BoardPack.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ifstream;
+using std::string;
+using std::vector;
+
+void usage();
+
+// Every board in a text file, each ended by a blank line as on the stdin of
+// flowfree-cli. Hints after a board are dropped.
+template <class F>
+void for_each_board(const string& file, F f) {
+	ifstream in(file);
+	if (!in.is_open()) {
+		throw std::runtime_error("Error: could not open input file " + file);
+	}
+	while (in) {
+		board hints;
+		board b = read_board(in, hints);
+		if (!b.empty()) {
+			f(b);
+		}
+	}
+}
+
+// The text files are read twice: once for the widest color, which fixes the
+// cell width, and once to write the boards
+int create(const string& pack, const vector<string>& files) {
+	int max_color = 0;
+	uint64_t count = 0;
+	for (auto& file : files) {
+		for_each_board(file, [&](const board& b) {
+			for (auto& row : b) {
+				max_color = std::max(max_color, *std::max_element(row.begin(), row.end()));
+			}
+			count++;
+		});
+	}
+	PackWriter writer(pack, pack_cell_bytes(max_color));
+	for (auto& file : files) {
+		for_each_board(file, [&](const board& b) { writer.add(b); });
+	}
+	writer.finish();
+	cerr << "Packed " << count << " boards" << endl;
+	return 0;
+}
+
+int extract(const string& file, uint64_t first, uint64_t count) {
+	std::ios::sync_with_stdio(false);
+	BoardPack pack(file);
+	for (uint64_t i = first; i < pack.count() && i - first < count; i++) {
+		for (auto& row : board_rows(pack.get(i))) {
+			cout << row << "\n";
+		}
+		cout << "\n";
+	}
+	cout.flush();
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	vector<string> args(argv + 1, argv + argc);
+	try {
+		if (args.size() >= 3 && args[0] == "create") {
+			return create(args[1], vector<string>(args.begin() + 2, args.end()));
+		}
+		if (args.size() >= 2 && args.size() <= 4 && args[0] == "extract") {
+			uint64_t first = args.size() > 2 ? std::stoull(args[2]) : 0;
+			uint64_t count = args.size() > 3 ? std::stoull(args[3]) : UINT64_MAX;
+			return extract(args[1], first, count);
+		}
+	}
+	catch (const std::logic_error&) {
+		cerr << "Error: invalid board number" << endl;
+		return 1;
+	}
+	catch (const std::runtime_error& e) {
+		cerr << e.what() << endl;
+		return 1;
+	}
+	usage();
+	return 1;
+}
+
+void usage() {
+	cout << "Usage: ./flowfree-pack create <pack.ffp> <boards.txt>..." << endl;
+	cout << "       ./flowfree-pack extract <pack.ffp> [<first> [<count>]]" << endl;
+	cout << "  create packs every board of the text files, several boards per file separated by blank lines" << endl;
+	cout << "  extract writes boards back as text, each followed by a blank line; first counts from 0" << endl;
+}
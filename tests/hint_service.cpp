@@ -0,0 +1,32 @@
+#include "HintService.hpp"
+
+#include <iostream>
+#include <sstream>
+
+// Several requests on one HintService: each solves under the options'
+// budget, not under what is left of the probes of the previous one. With no
+// conflicts allowed, every probe used up its budget at once.
+int main() {
+	std::istringstream in(
+		"d.....ab..\n"
+		"e..q....a.\n"
+		"...r......\n"
+		"......qpc.\n"
+		".dc.rp..b.\n"
+		"...efo..n.\n"
+		"......k.o.\n"
+		"f.hjk.lmn.\n"
+		"ghi.ji..ml\n"
+		".g........\n");
+	board b = read_board(in);
+	board state(b.size(), std::vector<int>(b[0].size(), -1));
+	HintService hints(b, SolverOptions(), 0);
+	for (int i = 0; i < 4; i++) {
+		Hint hint = hints.forced_cells(state);
+		if (hint.result != SolveResult::solved) {
+			std::cerr << "Request " << i + 1 << " was not solved" << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
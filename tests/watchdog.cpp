@@ -0,0 +1,39 @@
+#include "NativeSolver.hpp"
+#include "Solver.hpp"
+#include "Watchdog.hpp"
+
+#include <iostream>
+#include <sstream>
+
+// An interrupt that arrives while a solver is watched, after its search or
+// before it, stops at most that solve: once the solver is unwatched, solving
+// it again finds the solution.
+template <class S>
+bool solves_again(const char* name, const board& b) {
+	S s(b);
+	board hints(b.size(), std::vector<int>(b[0].size(), -1));
+	Watchdog watchdog(std::chrono::steady_clock::time_point::max());
+	watchdog.watch(s);
+	s.interrupt();
+	SolveResult first = s.solve(hints);
+	watchdog.unwatch(s);
+	SolveResult second = s.solve(hints);
+	if (first != SolveResult::indeterminate || second != SolveResult::solved) {
+		std::cerr << name << ": the interrupt outlived the solve it was aimed at" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main() {
+	std::istringstream in(
+		"a.b.c\n"
+		"..d.e\n"
+		".....\n"
+		".b.c.\n"
+		".ade.\n");
+	board b = read_board(in);
+	bool ok = solves_again<Solver>("Solver", b);
+	ok = solves_again<NativeSolver>("NativeSolver", b) && ok;
+	return ok ? 0 : 1;
+}